@@ -21,6 +21,18 @@
 #include <unistd.h>
 #include <string.h>
 #include <assert.h>
+#include <math.h>
+#include <errno.h>
+#include <fcntl.h>
+
+#if defined(__linux__)
+#	include <spawn.h>
+#	include <sys/wait.h>
+#endif
+
+#if !defined(_WIN32)
+#	include <dlfcn.h>
+#endif
 
 #include <lv2lint.h>
 
@@ -38,6 +50,7 @@
 #include <lv2/lv2plug.in/ns/ext/port-props/port-props.h>
 #include <lv2/lv2plug.in/ns/ext/buf-size/buf-size.h>
 #include <lv2/lv2plug.in/ns/ext/resize-port/resize-port.h>
+#include <lv2/lv2plug.in/ns/ext/midi/midi.h>
 #include <lv2/lv2plug.in/ns/ext/options/options.h>
 #include <lv2/lv2plug.in/ns/ext/data-access/data-access.h>
 #include <lv2/lv2plug.in/ns/ext/state/state.h>
@@ -46,8 +59,20 @@
 
 #ifdef ENABLE_ELF_TESTS
 #	include <fcntl.h>
+#	include <glob.h>
+#	include <libgen.h>
+#	include <limits.h>
 #	include <libelf.h>
 #	include <gelf.h>
+#	ifndef R_AARCH64_TLS_DTPMOD // older glibc names it R_AARCH64_TLS_DTPMOD64
+#		define R_AARCH64_TLS_DTPMOD 1028
+#	endif
+#	ifndef SHT_RELR
+#		define SHT_RELR 19
+#	endif
+#	ifdef ENABLE_CAPSTONE
+#		include <capstone/capstone.h>
+#	endif
 #endif
 
 #define MAPPER_API static inline
@@ -77,6 +102,32 @@ const char *colors [2][ANSI_COLOR_MAX] = {
 	}
 };
 
+static const limit_t limits [LIMIT_MAX] = {
+	[LIMIT_DLOPEN]        = {"dlopen",        50.0,    INFINITY}, // ms
+	[LIMIT_INSTANTIATION] = {"instantiation", 50.0,    INFINITY}, // ms
+	[LIMIT_RSS]           = {"rss",           32768.0, INFINITY}, // KiB
+	[LIMIT_HEAP]          = {"heap",          32768.0, INFINITY}, // KiB
+	[LIMIT_ALLOCATIONS]   = {"allocations",   10000.0, INFINITY},
+	[LIMIT_LOAD_COST]     = {"load-cost",     10000.0, INFINITY},
+	[LIMIT_LIBRARIES]     = {"libraries",     20.0,    INFINITY},
+	[LIMIT_LIBRARY_SIZE]  = {"library-size",  32768.0, INFINITY}, // KiB
+	[LIMIT_PATCH_LATENCY] = {"patch-latency", 3.0,     INFINITY}, // blocks
+	[LIMIT_PATCH_COST]    = {"patch-cost",    10.0,    INFINITY}, // us
+	[LIMIT_EVENT_COST]    = {"event-cost",    1.0,     INFINITY}, // us
+	[LIMIT_SWEEP_SPIKE]   = {"sweep-spike",   4.0,     INFINITY}, // ratio
+	[LIMIT_WCET]          = {"wcet",          25.0,    INFINITY}, // % of block
+	[LIMIT_LATENCY_ERROR] = {"latency-error", 2.0,     INFINITY}, // samples
+	[LIMIT_SCALING_LOSS]  = {"scaling-loss",  25.0,    INFINITY}, // %
+	[LIMIT_SPLIT_ERROR]   = {"split-error",   -100.0,  INFINITY}, // dB
+	[LIMIT_FINGERPRINT]   = {"fingerprint",   1.0,     INFINITY}, // dB
+	[LIMIT_INSTRUCTIONS]  = {"instructions",  2000.0,  INFINITY}, // per sample
+	[LIMIT_FIRST_RUN]     = {"first-run",     10.0,    INFINITY}, // ratio
+	[LIMIT_DEADLINE]      = {"deadline",      1.0,     INFINITY}, // missed blocks
+	[LIMIT_ALIGNMENT]     = {"alignment",     25.0,    INFINITY}, // %
+	[LIMIT_IDLE_COST]     = {"idle-cost",     75.0,    INFINITY}, // % of active cost
+	[LIMIT_LOG_RATE]      = {"log-rate",      10.0,    INFINITY} // messages per second
+};
+
 static void
 _map_uris(app_t *app)
 {
@@ -187,6 +238,9 @@ _map_uris(app_t *app)
 	app->uris.urid_unmap = lilv_new_uri(app->world, LV2_URID__unmap);
 
 	app->uris.rsz_resize = lilv_new_uri(app->world, LV2_RESIZE_PORT__resize);
+	app->uris.rsz_minimumSize = lilv_new_uri(app->world, LV2_RESIZE_PORT__minimumSize);
+
+	app->uris.midi_MidiEvent = lilv_new_uri(app->world, LV2_MIDI__MidiEvent);
 
 	app->uris.bufsz_boundedBlockLength = lilv_new_uri(app->world, LV2_BUF_SIZE__boundedBlockLength);
 	app->uris.bufsz_fixedBlockLength = lilv_new_uri(app->world, LV2_BUF_SIZE__fixedBlockLength);
@@ -318,6 +372,9 @@ _unmap_uris(app_t *app)
 	lilv_node_free(app->uris.urid_unmap);
 
 	lilv_node_free(app->uris.rsz_resize);
+	lilv_node_free(app->uris.rsz_minimumSize);
+
+	lilv_node_free(app->uris.midi_MidiEvent);
 
 	lilv_node_free(app->uris.bufsz_boundedBlockLength);
 	lilv_node_free(app->uris.bufsz_fixedBlockLength);
@@ -367,7 +424,8 @@ _respond(LV2_Worker_Respond_Handle instance, uint32_t size, const void *data)
 	app_t *app = instance;
 
 	if(app->work_iface && app->work_iface->work_response)
-		return app->work_iface->work_response(&app->instance, size, data);
+		return app->work_iface->work_response(
+			lilv_instance_get_handle(app->instance), size, data);
 
 	else return LV2_WORKER_ERR_UNKNOWN;
 }
@@ -378,10 +436,13 @@ _sched(LV2_Worker_Schedule_Handle instance, uint32_t size, const void *data)
 	app_t *app = instance;
 
 	LV2_Worker_Status status = LV2_WORKER_SUCCESS;
+	const phase_t phase = lv2lint_phase_set(PHASE_WORKER);
 	if(app->work_iface && app->work_iface->work)
-		status |= app->work_iface->work(&app->instance, _respond, app, size, data);
+		status |= app->work_iface->work(lilv_instance_get_handle(app->instance),
+			_respond, app, size, data);
+	lv2lint_phase_set(phase);
 	if(app->work_iface && app->work_iface->end_run)
-		status |= app->work_iface->end_run(&app->instance);
+		status |= app->work_iface->end_run(lilv_instance_get_handle(app->instance));
 
 	return status;
 }
@@ -403,30 +464,15 @@ strsep(char **sp, const char *sep)
 #endif
 
 static int
-_vprintf(void *data __unused, LV2_URID type __unused, const char *fmt,
+_vprintf(void *data, LV2_URID type, const char *fmt,
 	va_list args)
 {
-	char *buf = NULL;
-
-	if(asprintf(&buf, fmt, args) == -1)
-	{
-		buf = NULL;
-	}
-
-	if(buf)
-	{
-		const char *sep = "\n\0";
-		for(char *bufp = buf, *ptr = strsep(&bufp, sep);
-			ptr;
-			ptr = strsep(&bufp, sep) )
-		{
-			fprintf(stderr, "%s\n", ptr);
-		}
+	app_t *app = data;
 
-		free(buf);
-	}
+	lv2lint_callback(app, CALLBACK_LOG, fmt);
 
-	return 0;
+	// captured and attached to the plugin's results, see 'Log' test
+	return lv2lint_log_vprintf(type, fmt, args);
 }
 
 static int
@@ -442,6 +488,16 @@ _printf(void *data, LV2_URID type, const char *fmt, ...)
 	return ret;
 }
 
+static LV2_URID
+_map(LV2_URID_Map_Handle instance, const char *uri)
+{
+	app_t *app = instance;
+
+	lv2lint_callback(app, CALLBACK_MAP, uri);
+
+	return app->map->map(app->map->handle, uri);
+}
+
 static char *
 _mkpath(LV2_State_Make_Path_Handle instance __unused, const char *abstract_path)
 {
@@ -509,7 +565,7 @@ _usage(char **argv)
 		"OPTIONS\n"
 		"   [-v]                         print version information\n"
 		"   [-h]                         print usage information\n"
-		"   [-d]                         show verbose test item documentation\n"
+		"   [-d]                         show verbose test item documentation and plugin log\n"
 		"   [-I] INCLUDE_DIR             use include directory to search for plugins\n"
 #ifdef ENABLE_ONLINE_TESTS
 		"   [-o]                         run online test items\n"
@@ -517,11 +573,186 @@ _usage(char **argv)
 		"   [-g] GREETER                 custom mail greeter\n"
 #endif
 
+		"   [-p]                         run performance test items\n"
+		"   [-L] LIMIT=WARN[:FAIL]       set warn/fail threshold of performance limit\n"
+		"   [-Q] SEQUENCE_SIZE           atom sequence capacity per port [bytes]\n"
+		"   [-W] WCET_DIR                save worst-case execution time cases to directory\n"
+		"   [-T] THREADS                 run as many instances concurrently on pinned threads\n"
+		"   [-X] CPU[:MEM]               run CPU and memory stressor threads during deadline test\n"
+		"   [-G] FINGERPRINT_DIR         store and compare output fingerprints in directory\n"
+		"   [-R] PROFILE_DIR             save sampled run() call stacks to directory\n"
 		"   [-S] (no)warn|note|pass|all  show warnings, notes, passes or all\n"
-		"   [-E] (no)warn|note|all       treat warnings, notes or all as errors\n\n"
+		"   [-E] (no)warn|note|all       treat warnings, notes or all as errors\n"
+		"\n"
+		"LIMITS\n"
+		"   dlopen                       time to load plugin binary [ms]\n"
+		"   instantiation                time to instantiate plugin [ms]\n"
+		"   rss                          resident set size increase [KiB]\n"
+		"   heap                         heap peak while instantiating [KiB]\n"
+		"   allocations                  heap allocations while instantiating\n"
+		"   load-cost                    static dlopen cost score of plugin binary\n"
+		"   libraries                    shared libraries loaded with plugin binary\n"
+		"   library-size                 size of plugin binary and its libraries [KiB]\n"
+		"   patch-latency                patch:Set/patch:Get round-trip [blocks]\n"
+		"   patch-cost                   run() cost per patch:Set message [us]\n"
+		"   event-cost                   run() cost per dense MIDI event [us]\n"
+		"   sweep-spike                  worst run() cost of control sweep vs. default\n"
+		"   wcet                         worst-case run() duration [%% of block]\n"
+		"   latency-error                reported vs. measured latency [samples]\n"
+		"   scaling-loss                 efficiency loss of concurrent instances [%%]\n"
+		"   split-error                  output deviation of irregular block splits [dB]\n"
+		"   fingerprint                  output envelope change vs. stored version [dB]\n"
+		"   instructions                 instructions retired by run() per sample\n"
+		"   first-run                    duration of first run() call vs. steady state\n"
+		"   deadline                     blocks not done within period under SCHED_FIFO\n"
+		"   alignment                    slowdown of least vs. 64-byte aligned buffers [%%]\n"
+		"   idle-cost                    run() cost on settled silence vs. noise [%%]\n"
+		"   log-rate                     log messages per second from run()\n\n"
 		, argv[0]);
 }
 
+static bool
+_parse_sequence_size(app_t *app, const char *arg)
+{
+	char *end = NULL;
+	const unsigned long size = strtoul(arg, &end, 10);
+
+	// must at least hold a sequence header and a MIDI event
+	if( (end == arg) || *end || (size < 64) || (size > INT32_MAX) )
+	{
+		return false;
+	}
+
+	app->sequence_size = size;
+
+	return true;
+}
+
+static bool
+_parse_threads(app_t *app, const char *arg)
+{
+	char *end = NULL;
+	const unsigned long threads = strtoul(arg, &end, 10);
+
+	if( (end == arg) || *end || (threads < 1) || (threads > 1024) )
+	{
+		return false;
+	}
+
+	app->threads = threads;
+
+	return true;
+}
+
+static bool
+_parse_stressors(app_t *app, const char *arg)
+{
+	char *end = NULL;
+	const unsigned long cpu = strtoul(arg, &end, 10);
+	unsigned long mem = 0;
+
+	if( (end == arg) || (cpu > 1024) )
+	{
+		return false;
+	}
+
+	if(*end == ':')
+	{
+		arg = ++end;
+		mem = strtoul(arg, &end, 10);
+
+		if( (end == arg) || (mem > 1024) )
+		{
+			return false;
+		}
+	}
+
+	app->stress_cpu = cpu;
+	app->stress_mem = mem;
+
+	return *end == '\0';
+}
+
+static const char *helpers [HELPER_MAX] = {
+	[HELPER_LOAD] = "load",
+	[HELPER_ALIGN] = "align"
+};
+
+static bool
+_parse_helper(app_t *app, const char *arg)
+{
+	const char *sep = strchr(arg, ':');
+	if(!sep)
+	{
+		return false;
+	}
+
+	char *end = NULL;
+	const long fd = strtol(sep + 1, &end, 10);
+
+	if( (end == sep + 1) || (*end != '\0') || (fd < 0) )
+	{
+		return false;
+	}
+
+	const size_t len = sep - arg;
+
+	for(unsigned h = HELPER_NONE + 1; h < HELPER_MAX; h++)
+	{
+		if( (strlen(helpers[h]) == len) && !strncmp(arg, helpers[h], len) )
+		{
+			app->helper = h;
+			app->helper_fd = fd;
+
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static bool
+_parse_limit(app_t *app, const char *arg)
+{
+	const char *val = strchr(arg, '=');
+	if(!val)
+	{
+		return false;
+	}
+
+	for(unsigned i = 0; i < LIMIT_MAX; i++)
+	{
+		limit_t *limit = &app->limits[i];
+
+		if( (strlen(limit->id) != (size_t)(val - arg))
+			|| strncmp(arg, limit->id, val - arg) )
+		{
+			continue;
+		}
+
+		char *end = NULL;
+		const double warn = strtod(++val, &end);
+		if(end != val)
+		{
+			limit->warn = warn;
+		}
+
+		if(*end == ':')
+		{
+			val = ++end;
+			const double fail = strtod(val, &end);
+			if(end != val)
+			{
+				limit->fail = fail;
+			}
+		}
+
+		return *end == '\0';
+	}
+
+	return false;
+}
+
 #ifdef ENABLE_ONLINE_TESTS
 static const char *http_prefix = "http://";
 static const char *https_prefix = "https://";
@@ -584,8 +815,54 @@ _append_to(char **dst, const char *src)
 	}
 }
 
+static int
+_sym_cmp(const void *a, const void *b)
+{
+	const sym_t *sym_a = a;
+	const sym_t *sym_b = b;
+
+	return (sym_a->addr > sym_b->addr) - (sym_a->addr < sym_b->addr);
+}
+
+static void
+_symtab_append(Elf *elf, const GElf_Shdr *shdr, Elf_Data *data, symtab_t *symtab)
+{
+	const unsigned count = shdr->sh_size / shdr->sh_entsize;
+
+	sym_t *syms = realloc(symtab->syms, (symtab->n_syms + count) * sizeof(sym_t));
+	if(!syms)
+	{
+		return;
+	}
+	symtab->syms = syms;
+
+	for(unsigned i = 0; i < count; i++)
+	{
+		GElf_Sym sym;
+		memset(&sym, 0x0, sizeof(GElf_Sym));
+		gelf_getsym(data, i, &sym);
+
+		if( (GELF_ST_TYPE(sym.st_info) != STT_FUNC) || !sym.st_value)
+		{
+			continue;
+		}
+
+		const char *name = elf_strptr(elf, shdr->sh_link, sym.st_name);
+		if(!name)
+		{
+			continue;
+		}
+
+		sym_t *dst = &symtab->syms[symtab->n_syms++];
+		dst->addr = sym.st_value;
+		dst->size = sym.st_size;
+		dst->name = strdup(name);
+	}
+}
+
 bool
-test_visibility(const char *path, const char *description, char **symbols)
+test_visibility(const char *path, const char *description, char **symbols,
+	symtab_t *symtab)
 {
 	static const char *whitelist [] = {
 		// C
@@ -610,8 +887,14 @@ test_visibility(const char *path, const char *description, char **symbols)
 	const unsigned n_whitelist = sizeof(whitelist) / sizeof(const char *);
 
 	bool desc = false;
+	bool checked = false;
 	unsigned invalid = 0;
 
+	if(symtab)
+	{
+		memset(symtab, 0x0, sizeof(symtab_t));
+	}
+
 	const int fd = open(path, O_RDONLY);
 	if(fd != -1)
 	{
@@ -634,6 +917,19 @@ test_visibility(const char *path, const char *description, char **symbols)
 					Elf_Data *data = elf_getdata(scn, NULL);
 					const unsigned count = shdr.sh_size / shdr.sh_entsize;
 
+					// .symtab also has local functions, .dynsym is all that is left when stripped
+					if(symtab)
+					{
+						_symtab_append(elf, &shdr, data, symtab);
+					}
+
+					// visibility is checked on the first table only
+					if(checked)
+					{
+						continue;
+					}
+					checked = true;
+
 					// iterate over symbol names
 					for(unsigned i = 0; i < count; i++)
 					{
@@ -677,7 +973,10 @@ test_visibility(const char *path, const char *description, char **symbols)
 						}
 					}
 
-					break;
+					if(!symtab)
+					{
+						break;
+					}
 				}
 			}
 			elf_end(elf);
@@ -685,6 +984,11 @@ test_visibility(const char *path, const char *description, char **symbols)
 		close(fd);
 	}
 
+	if(symtab)
+	{
+		qsort(symtab->syms, symtab->n_syms, sizeof(sym_t), _sym_cmp);
+	}
+
 	return !(!desc || invalid);
 }
 
@@ -772,105 +1076,2018 @@ test_shared_libraries(const char *path, const char *const *whitelist,
 
 	return !invalid;
 }
-#endif
 
 static void
-_state_set_value(const char *symbol __unused, void *data __unused,
-	const void *value __unused, uint32_t size __unused, uint32_t type __unused)
+_load_cost_relocation(load_cost_t *cost, GElf_Half machine, unsigned type,
+	const GElf_Sym *sym)
 {
-	//FIXME
+	bool relative = false;
+	bool irelative = false;
+	bool tls_dynamic = false;
+	bool jump_slot = false;
+
+	switch(machine)
+	{
+		case EM_X86_64:
+		{
+			relative = (type == R_X86_64_RELATIVE);
+			irelative = (type == R_X86_64_IRELATIVE);
+			tls_dynamic = (type == R_X86_64_DTPMOD64);
+			jump_slot = (type == R_X86_64_JUMP_SLOT);
+		} break;
+		case EM_386:
+		{
+			relative = (type == R_386_RELATIVE);
+			irelative = (type == R_386_IRELATIVE);
+			tls_dynamic = (type == R_386_TLS_DTPMOD32);
+			jump_slot = (type == R_386_JMP_SLOT);
+		} break;
+		case EM_AARCH64:
+		{
+			relative = (type == R_AARCH64_RELATIVE);
+			irelative = (type == R_AARCH64_IRELATIVE);
+			tls_dynamic = (type == R_AARCH64_TLS_DTPMOD) || (type == R_AARCH64_TLSDESC);
+			jump_slot = (type == R_AARCH64_JUMP_SLOT);
+		} break;
+		case EM_ARM:
+		{
+			relative = (type == R_ARM_RELATIVE);
+			irelative = (type == R_ARM_IRELATIVE);
+			tls_dynamic = (type == R_ARM_TLS_DTPMOD32) || (type == R_ARM_TLS_DESC);
+			jump_slot = (type == R_ARM_JUMP_SLOT);
+		} break;
+		default:
+		{
+			relative = !sym;
+		} break;
+	}
+
+	if(tls_dynamic)
+	{
+		cost->tls_dynamic++;
+	}
+
+	if(jump_slot)
+	{
+		cost->jump_slots++;
+	}
+
+	if(relative)
+	{
+		cost->relative++;
+	}
+	else if(irelative)
+	{
+		cost->irelative++;
+	}
+	else if(sym)
+	{
+		cost->symbolic++;
+
+		const unsigned bind = GELF_ST_BIND(sym->st_info);
+		const unsigned vis = GELF_ST_VISIBILITY(sym->st_other);
+
+		// references to own default-visibility symbols may be interposed
+		if( (sym->st_shndx != SHN_UNDEF) && (vis == STV_DEFAULT)
+			&& ( (bind == STB_GLOBAL) || (bind == STB_WEAK) ) )
+		{
+			cost->interposable++;
+		}
+	}
 }
 
-int
-main(int argc, char **argv)
+bool
+test_load_cost(const char *path, load_cost_t *cost)
 {
-	static app_t app;
-	app.atty = isatty(1);
-	app.show = LINT_FAIL | LINT_WARN; // always report failed and warned tests
-	app.mask = LINT_FAIL; // always fail at failed tests
-	const char *include_dir = NULL;
-	LilvNode *bundle_node = NULL;
-#ifdef ENABLE_ONLINE_TESTS
-	app.greet = "Dear LV2 plugin developer\n"
-		"\n"
-		"We would like to congratulate you for your efforts to have created this\n"
-		"awesome plugin for the LV2 ecosystem.\n"
-		"\n"
-		"However, we have found some minor issues where your plugin deviates from\n"
-		"the LV2 plugin specification and/or its best implementation practices.\n"
-		"By fixing those, you can make your plugin more conforming and thus likely\n"
-		"usable in more hosts and with less issues for your users.\n"
-		"\n"
-		"Kindly find below an automatically generated bug report with a summary\n"
-		"of potential issues.\n"
-		"\n"
-		"Yours sincerely\n"
-		"                                 /The unofficial LV2 inquisitorial squad/\n"
-		"\n"
-		"---\n\n";
-#endif
-
-	fprintf(stderr,
-		"%s "LV2LINT_VERSION"\n"
-		"Copyright (c) 2016-2019 Hanspeter Portner (dev@open-music-kontrollers.ch)\n"
-		"Released under Artistic License 2.0 by Open Music Kontrollers\n",
-		argv[0]);
+	memset(cost, 0x0, sizeof(load_cost_t));
 
-	int c;
-#ifdef ENABLE_ONLINE_TESTS
-	while( (c = getopt(argc, argv, "vhdomg:S:E:I:") ) != -1)
-#else
-	while( (c = getopt(argc, argv, "vhdS:E:I:") ) != -1)
-#endif
+	const int fd = open(path, O_RDONLY);
+	if(fd != -1)
 	{
-		switch(c)
+		elf_version(EV_CURRENT);
+
+		Elf *elf = elf_begin(fd, ELF_C_READ, NULL);
+		if(elf)
 		{
-			case 'v':
-				_version();
-				return 0;
-			case 'h':
-				_usage(argv);
-				return 0;
-			case 'd':
-				app.debug = true;
-				break;
-			case 'I':
-				include_dir = optarg;
-				break;
-#ifdef ENABLE_ONLINE_TESTS
-			case 'o':
-				app.online = true;
-				break;
-			case 'm':
-				app.mailto = true;
-				app.atty = false;
-				break;
-			case 'g':
-				app.greet = optarg;
-				break;
-#endif
-			case 'S':
-				if(!strcmp(optarg, "warn"))
-				{
-					app.show |= LINT_WARN;
-				}
-				else if(!strcmp(optarg, "note"))
-				{
-					app.show |= LINT_NOTE;
-				}
-				else if(!strcmp(optarg, "pass"))
-				{
-					app.show |= LINT_PASS;
-				}
-				else if(!strcmp(optarg, "all"))
-				{
-					app.show |= (LINT_WARN | LINT_NOTE | LINT_PASS);
-				}
+			GElf_Ehdr ehdr;
+			memset(&ehdr, 0x0, sizeof(GElf_Ehdr));
+			gelf_getehdr(elf, &ehdr);
 
-				else if(!strcmp(optarg, "nowarn"))
-				{
-					app.show &= ~LINT_WARN;
-				}
+			const size_t ptr_size = (gelf_getclass(elf) == ELFCLASS64) ? 8 : 4;
+
+			for(Elf_Scn *scn = elf_nextscn(elf, NULL);
+				scn;
+				scn = elf_nextscn(elf, scn))
+			{
+				GElf_Shdr shdr;
+				memset(&shdr, 0x0, sizeof(GElf_Shdr));
+				gelf_getshdr(scn, &shdr);
+
+				if(shdr.sh_type == SHT_DYNAMIC)
+				{
+					// found a dynamic table
+					Elf_Data *data = elf_getdata(scn, NULL);
+					const unsigned count = shdr.sh_size / shdr.sh_entsize;
+
+					for(unsigned i = 0; data && (i < count); i++)
+					{
+						GElf_Dyn dyn;
+						memset(&dyn, 0x0, sizeof(GElf_Dyn));
+						gelf_getdyn(data, i, &dyn);
+
+						switch(dyn.d_tag)
+						{
+							case DT_TEXTREL:
+							{
+								cost->text_relocations = true;
+							} break;
+							case DT_SYMBOLIC:
+							{
+								cost->symbolic_binding = true;
+							} break;
+							case DT_GNU_HASH:
+							{
+								cost->gnu_hash = true;
+							} break;
+							case DT_INIT_ARRAYSZ:
+							{
+								cost->constructors += dyn.d_un.d_val / ptr_size;
+							} break;
+							case DT_BIND_NOW:
+							{
+								cost->bind_now = true;
+							} break;
+							case DT_FLAGS:
+							{
+								if(dyn.d_un.d_val & DF_TEXTREL)
+								{
+									cost->text_relocations = true;
+								}
+								if(dyn.d_un.d_val & DF_SYMBOLIC)
+								{
+									cost->symbolic_binding = true;
+								}
+								if(dyn.d_un.d_val & DF_BIND_NOW)
+								{
+									cost->bind_now = true;
+								}
+							} break;
+							case DT_FLAGS_1:
+							{
+								if(dyn.d_un.d_val & DF_1_NOW)
+								{
+									cost->bind_now = true;
+								}
+							} break;
+						}
+					}
+				}
+				else if(shdr.sh_type == SHT_RELR)
+				{
+					// found packed relative relocations
+					Elf_Data *data = elf_getdata(scn, NULL);
+					const size_t count = data ? data->d_size / ptr_size : 0;
+
+					for(size_t i = 0; i < count; i++)
+					{
+						const uint64_t entry = (ptr_size == 8)
+							? ((const uint64_t *)data->d_buf)[i]
+							: ((const uint32_t *)data->d_buf)[i];
+
+						// even entries are addresses, odd ones bitmaps of further addresses
+						cost->relative += (entry & 1)
+							? __builtin_popcountll(entry) - 1
+							: 1;
+					}
+				}
+				else if( (shdr.sh_type == SHT_RELA) || (shdr.sh_type == SHT_REL) )
+				{
+					// found relocations, only consider dynamic ones
+					Elf_Data *data = elf_getdata(scn, NULL);
+					Elf_Scn *sym_scn = elf_getscn(elf, shdr.sh_link);
+					const unsigned count = shdr.sh_size / shdr.sh_entsize;
+
+					GElf_Shdr sym_shdr;
+					memset(&sym_shdr, 0x0, sizeof(GElf_Shdr));
+
+					if(!data || !sym_scn || !gelf_getshdr(sym_scn, &sym_shdr)
+						|| (sym_shdr.sh_type != SHT_DYNSYM) )
+					{
+						continue;
+					}
+
+					Elf_Data *sym_data = elf_getdata(sym_scn, NULL);
+
+					for(unsigned i = 0; i < count; i++)
+					{
+						GElf_Xword info = 0;
+
+						if(shdr.sh_type == SHT_RELA)
+						{
+							GElf_Rela rela;
+							memset(&rela, 0x0, sizeof(GElf_Rela));
+							gelf_getrela(data, i, &rela);
+							info = rela.r_info;
+						}
+						else
+						{
+							GElf_Rel rel;
+							memset(&rel, 0x0, sizeof(GElf_Rel));
+							gelf_getrel(data, i, &rel);
+							info = rel.r_info;
+						}
+
+						GElf_Sym sym;
+						memset(&sym, 0x0, sizeof(GElf_Sym));
+
+						const bool has_sym = GELF_R_SYM(info)
+							&& gelf_getsym(sym_data, GELF_R_SYM(info), &sym);
+
+						_load_cost_relocation(cost, ehdr.e_machine, GELF_R_TYPE(info),
+							has_sym ? &sym : NULL);
+					}
+				}
+			}
+
+			elf_end(elf);
+		}
+		close(fd);
+	}
+
+	// weights in units of a relative relocation
+	const double lookup = cost->gnu_hash ? 10.0 : 20.0;
+
+	cost->score = cost->relative
+		+ cost->symbolic * lookup
+		+ cost->irelative * 50.0
+		+ cost->tls_dynamic * 50.0
+		+ cost->constructors * 100.0
+		+ (cost->text_relocations ? 1000.0 : 0.0);
+
+	return !cost->text_relocations;
+}
+
+typedef struct _link_t link_t;
+
+struct _link_t {
+	int dep; // index into dependency cache
+	int parent; // index of loading object in breadth-first queue
+};
+
+static void
+_dirs_append(app_t *app, const char *dir)
+{
+	for(unsigned i = 0; i < app->n_dirs; i++)
+	{
+		if(!strcmp(app->dirs[i], dir))
+		{
+			return; // already listed
+		}
+	}
+
+	char **dirs = realloc(app->dirs, (app->n_dirs + 1) * sizeof(char *));
+	if(dirs)
+	{
+		app->dirs = dirs;
+		app->dirs[app->n_dirs++] = strdup(dir);
+	}
+}
+
+static void
+_dirs_parse_conf(app_t *app, const char *path, unsigned depth)
+{
+	FILE *f = fopen(path, "r");
+	if(!f || (depth > 8) )
+	{
+		if(f)
+		{
+			fclose(f);
+		}
+
+		return;
+	}
+
+	char line [PATH_MAX];
+	while(fgets(line, sizeof(line), f))
+	{
+		char *comment = strchr(line, '#');
+		if(comment)
+		{
+			*comment = '\0';
+		}
+
+		char *dir = line;
+		while(isspace(*dir))
+		{
+			dir++;
+		}
+
+		char *end = dir + strlen(dir);
+		while( (end > dir) && isspace(end[-1]) )
+		{
+			*--end = '\0';
+		}
+
+		if(!strncmp(dir, "include", 7) && isspace(dir[7]))
+		{
+			char *pattern = dir + 8;
+			while(isspace(*pattern))
+			{
+				pattern++;
+			}
+
+			// relative include patterns are relative to the including file
+			char *abs_pattern = NULL;
+			if(*pattern != '/')
+			{
+				char *base = strdup(path); // dirname may modify its argument
+
+				if(!base || (asprintf(&abs_pattern, "%s/%s", dirname(base), pattern) == -1) )
+				{
+					abs_pattern = NULL;
+				}
+
+				free(base);
+			}
+
+			glob_t globbuf;
+			if(!glob(abs_pattern ? abs_pattern : pattern, 0, NULL, &globbuf))
+			{
+				for(size_t i = 0; i < globbuf.gl_pathc; i++)
+				{
+					_dirs_parse_conf(app, globbuf.gl_pathv[i], depth + 1);
+				}
+
+				globfree(&globbuf);
+			}
+
+			free(abs_pattern);
+		}
+		else if(*dir == '/')
+		{
+			_dirs_append(app, dir);
+		}
+	}
+
+	fclose(f);
+}
+
+static void
+_dirs_init(app_t *app)
+{
+	static const char *trusted [] = {
+		"/lib64",
+		"/usr/lib64",
+		"/lib",
+		"/usr/lib"
+	};
+	const unsigned n_trusted = sizeof(trusted) / sizeof(const char *);
+
+	if(app->dirs)
+	{
+		return; // already initialized
+	}
+
+	_dirs_parse_conf(app, "/etc/ld.so.conf", 0);
+
+	for(unsigned i = 0; i < n_trusted; i++)
+	{
+		_dirs_append(app, trusted[i]);
+	}
+}
+
+static int
+_dep_load(app_t *app, const char *path)
+{
+	char *real = realpath(path, NULL);
+	if(!real)
+	{
+		return -1;
+	}
+
+	// parsed already for this or a previous plugin?
+	for(unsigned i = 0; i < app->n_deps; i++)
+	{
+		if(!strcmp(app->deps[i].path, real))
+		{
+			free(real);
+			return i;
+		}
+	}
+
+	dep_t dep;
+	memset(&dep, 0x0, sizeof(dep_t));
+	dep.path = real;
+
+	const int fd = open(real, O_RDONLY);
+	if(fd != -1)
+	{
+		elf_version(EV_CURRENT);
+
+		Elf *elf = elf_begin(fd, ELF_C_READ, NULL);
+		if(elf)
+		{
+			GElf_Ehdr ehdr;
+			size_t n_phdrs = 0;
+
+			if(gelf_getehdr(elf, &ehdr))
+			{
+				dep.valid = true;
+				dep.machine = ehdr.e_machine;
+				dep.elf_class = gelf_getclass(elf);
+			}
+
+			elf_getphdrnum(elf, &n_phdrs);
+
+			for(unsigned i = 0; i < n_phdrs; i++)
+			{
+				GElf_Phdr phdr;
+				memset(&phdr, 0x0, sizeof(GElf_Phdr));
+				gelf_getphdr(elf, i, &phdr);
+
+				if(phdr.p_type == PT_LOAD)
+				{
+					dep.size += phdr.p_memsz;
+				}
+			}
+
+			for(Elf_Scn *scn = elf_nextscn(elf, NULL);
+				scn;
+				scn = elf_nextscn(elf, scn))
+			{
+				GElf_Shdr shdr;
+				memset(&shdr, 0x0, sizeof(GElf_Shdr));
+				gelf_getshdr(scn, &shdr);
+
+				if(shdr.sh_type == SHT_DYNAMIC)
+				{
+					// found a dynamic table
+					Elf_Data *data = elf_getdata(scn, NULL);
+					const unsigned count = shdr.sh_size / shdr.sh_entsize;
+
+					for(unsigned i = 0; data && (i < count); i++)
+					{
+						GElf_Dyn dyn;
+						memset(&dyn, 0x0, sizeof(GElf_Dyn));
+						gelf_getdyn(data, i, &dyn);
+
+						const char *name = NULL;
+
+						switch(dyn.d_tag)
+						{
+							case DT_NEEDED:
+							{
+								name = elf_strptr(elf, shdr.sh_link, dyn.d_un.d_val);
+
+								char **needed = realloc(dep.needed, (dep.n_needed + 1) * sizeof(char *));
+								if(name && needed)
+								{
+									dep.needed = needed;
+									dep.needed[dep.n_needed++] = strdup(name);
+								}
+							} break;
+							case DT_RPATH:
+							{
+								name = elf_strptr(elf, shdr.sh_link, dyn.d_un.d_val);
+
+								if(name && !dep.rpath)
+								{
+									dep.rpath = strdup(name);
+								}
+							} break;
+							case DT_RUNPATH:
+							{
+								name = elf_strptr(elf, shdr.sh_link, dyn.d_un.d_val);
+
+								if(name && !dep.runpath)
+								{
+									dep.runpath = strdup(name);
+								}
+							} break;
+						}
+					}
+
+					break;
+				}
+			}
+
+			elf_end(elf);
+		}
+		close(fd);
+	}
+
+	dep_t *deps = realloc(app->deps, (app->n_deps + 1) * sizeof(dep_t));
+	if(!deps)
+	{
+		free(real);
+		return -1;
+	}
+
+	app->deps = deps;
+	app->deps[app->n_deps] = dep;
+
+	return app->n_deps++;
+}
+
+static int
+_dep_find_in(app_t *app, const char *paths, const char *origin,
+	const char *name, const dep_t *root)
+{
+	int idx = -1;
+
+	char *dup = strdup(paths);
+	char *rest = dup;
+	char *dir;
+
+	while(dup && (idx == -1) && (dir = strsep(&rest, ":")))
+	{
+		char *candidate = NULL;
+
+		if(!*dir)
+		{
+			continue;
+		}
+
+		// expand $ORIGIN and ${ORIGIN}
+		if(!strncmp(dir, "$ORIGIN", 7))
+		{
+			if(asprintf(&candidate, "%s%s/%s", origin, dir + 7, name) == -1)
+			{
+				candidate = NULL;
+			}
+		}
+		else if(!strncmp(dir, "${ORIGIN}", 9))
+		{
+			if(asprintf(&candidate, "%s%s/%s", origin, dir + 9, name) == -1)
+			{
+				candidate = NULL;
+			}
+		}
+		else if(asprintf(&candidate, "%s/%s", dir, name) == -1)
+		{
+			candidate = NULL;
+		}
+
+		if(candidate && !access(candidate, R_OK))
+		{
+			const int i = _dep_load(app, candidate);
+
+			// skip libraries built for other architectures
+			if( (i != -1) && app->deps[i].valid
+				&& (app->deps[i].machine == root->machine)
+				&& (app->deps[i].elf_class == root->elf_class) )
+			{
+				idx = i;
+			}
+		}
+
+		free(candidate);
+	}
+
+	free(dup);
+
+	return idx;
+}
+
+static char *
+_dep_origin(const char *path)
+{
+	char *origin = strdup(path);
+	char *slash = origin ? strrchr(origin, '/') : NULL;
+
+	if(slash)
+	{
+		*slash = '\0';
+	}
+
+	return origin;
+}
+
+static int
+_dep_resolve(app_t *app, const link_t *links, unsigned q, const char *name)
+{
+	if(strchr(name, '/'))
+	{
+		return _dep_load(app, name);
+	}
+
+	// copy, as the cache may be reallocated while searching
+	const dep_t root = app->deps[links[0].dep];
+	const dep_t dep = app->deps[links[q].dep];
+	char *origin = _dep_origin(dep.path);
+	int found = -1;
+
+	// DT_RPATH of the loading object and its loaders, unless DT_RUNPATH is set
+	if(!dep.runpath)
+	{
+		for(int i = q; (found == -1) && (i != -1); i = links[i].parent)
+		{
+			const dep_t loader = app->deps[links[i].dep];
+
+			if(loader.rpath)
+			{
+				char *loader_origin = _dep_origin(loader.path);
+
+				found = _dep_find_in(app, loader.rpath, loader_origin, name, &root);
+				free(loader_origin);
+			}
+		}
+	}
+
+	const char *ld_library_path = getenv("LD_LIBRARY_PATH");
+	if( (found == -1) && ld_library_path)
+	{
+		found = _dep_find_in(app, ld_library_path, origin, name, &root);
+	}
+
+	if( (found == -1) && dep.runpath)
+	{
+		found = _dep_find_in(app, dep.runpath, origin, name, &root);
+	}
+
+	for(unsigned i = 0; (found == -1) && (i < app->n_dirs); i++)
+	{
+		found = _dep_find_in(app, app->dirs[i], origin, name, &root);
+	}
+
+	free(origin);
+
+	return found;
+}
+
+bool
+test_dependencies(app_t *app, const char *path, const char *const *blacklist,
+	unsigned n_blacklist, closure_t *closure)
+{
+	memset(closure, 0x0, sizeof(closure_t));
+
+	_dirs_init(app);
+
+	const int root = _dep_load(app, path);
+	if( (root == -1) || !app->deps[root].valid)
+	{
+		return true;
+	}
+
+	unsigned n_links = 1;
+	unsigned n_unresolved = 0;
+	unsigned n_blacklisted = 0;
+	link_t *links = malloc(sizeof(link_t));
+	if(!links)
+	{
+		return true;
+	}
+
+	links[0].dep = root;
+	links[0].parent = -1;
+
+	// breadth-first, like the dynamic linker
+	for(unsigned q = 0; q < n_links; q++)
+	{
+		const unsigned n_needed = app->deps[links[q].dep].n_needed;
+
+		closure->n_libraries += (q > 0);
+		closure->size += app->deps[links[q].dep].size;
+
+		for(unsigned n = 0; n < n_needed; n++)
+		{
+			const char *name = app->deps[links[q].dep].needed[n];
+			const int found = _dep_resolve(app, links, q, name);
+			bool linked = false;
+
+			if(found == -1)
+			{
+				if(n_unresolved <= 10)
+				{
+					_append_to(&closure->unresolved, (n_unresolved == 10)
+						? "... there is more, but the rest is being truncated"
+						: name);
+				}
+				n_unresolved++;
+				continue;
+			}
+
+			for(unsigned i = 0; i < n_links; i++)
+			{
+				if(links[i].dep == found)
+				{
+					linked = true;
+					break;
+				}
+			}
+
+			if(linked)
+			{
+				continue; // already part of the closure
+			}
+
+			link_t *tmp = realloc(links, (n_links + 1) * sizeof(link_t));
+			if(!tmp)
+			{
+				continue;
+			}
+
+			links = tmp;
+			links[n_links].dep = found;
+			links[n_links].parent = q;
+			n_links++;
+
+			for(unsigned j = 0; j < n_blacklist; j++)
+			{
+				if(!strncmp(name, blacklist[j], strlen(blacklist[j])))
+				{
+					if(n_blacklisted <= 10)
+					{
+						_append_to(&closure->blacklisted, (n_blacklisted == 10)
+							? "... there is more, but the rest is being truncated"
+							: name);
+					}
+					n_blacklisted++;
+					break;
+				}
+			}
+		}
+	}
+
+	free(links);
+
+	return !(n_unresolved || n_blacklisted);
+}
+
+void
+free_dependencies(app_t *app)
+{
+	for(unsigned i = 0; i < app->n_deps; i++)
+	{
+		dep_t *dep = &app->deps[i];
+
+		for(unsigned j = 0; j < dep->n_needed; j++)
+		{
+			free(dep->needed[j]);
+		}
+
+		free(dep->needed);
+		free(dep->rpath);
+		free(dep->runpath);
+		free(dep->path);
+	}
+
+	for(unsigned i = 0; i < app->n_dirs; i++)
+	{
+		free(app->dirs[i]);
+	}
+
+	free(app->deps);
+	free(app->dirs);
+}
+
+const char *
+lookup_symtab(const symtab_t *symtab, uint64_t addr)
+{
+	unsigned lo = 0;
+	unsigned hi = symtab->n_syms;
+
+	// find last symbol starting at or before address
+	while(lo < hi)
+	{
+		const unsigned mid = lo + (hi - lo) / 2;
+
+		if(symtab->syms[mid].addr <= addr)
+		{
+			lo = mid + 1;
+		}
+		else
+		{
+			hi = mid;
+		}
+	}
+
+	if(lo == 0)
+	{
+		return NULL;
+	}
+
+	const sym_t *sym = &symtab->syms[lo - 1];
+
+	// symbols without size, e.g. from assembly, extend up to the next one
+	return (!sym->size || (addr < sym->addr + sym->size))
+		? sym->name
+		: NULL;
+}
+
+void
+free_symtab(symtab_t *symtab)
+{
+	for(unsigned i = 0; i < symtab->n_syms; i++)
+	{
+		free(symtab->syms[i].name);
+	}
+
+	free(symtab->syms);
+	memset(symtab, 0x0, sizeof(symtab_t));
+}
+
+#	ifdef ENABLE_CAPSTONE
+#	define GRAPH_BUDGET  0x100000 // maximal number of instructions to decode
+#	define GRAPH_VISITED 0x20000 // maximal number of basic blocks to visit
+
+typedef enum _target_t {
+	TARGET_NONE,
+	TARGET_DIRECT,
+	TARGET_SLOT
+} target_t;
+
+typedef struct _text_t text_t;
+typedef struct _slot_t slot_t;
+typedef struct _track_t track_t;
+typedef struct _graph_t graph_t;
+
+struct _text_t {
+	uint64_t addr;
+	uint64_t size;
+	const uint8_t *buf;
+	bool plt;
+};
+
+struct _slot_t {
+	uint64_t addr;
+	const char *name;
+};
+
+struct _track_t {
+	unsigned reg;
+	uint64_t addr;
+};
+
+struct _graph_t {
+	csh handle;
+	cs_insn *insn;
+	cs_insn *stub; // for PLT probes amid the walk over insn
+	GElf_Half machine;
+	text_t *texts;
+	unsigned n_texts;
+	slot_t *slots;
+	unsigned n_slots;
+	uint64_t *stack;
+	unsigned n_stack;
+	uint64_t *visited;
+	unsigned n_visited;
+	unsigned budget;
+	track_t page, slot; // aarch64 adrp/ldr tracking
+	bool fpenv;
+	const char *const *blacklist;
+	unsigned n_blacklist;
+	const char **seen;
+	unsigned n_seen;
+	char **symbols;
+};
+
+static int
+_slot_cmp(const void *a, const void *b)
+{
+	const slot_t *slot_a = a;
+	const slot_t *slot_b = b;
+
+	if(slot_a->addr < slot_b->addr)
+	{
+		return -1;
+	}
+	else if(slot_a->addr > slot_b->addr)
+	{
+		return 1;
+	}
+
+	return 0;
+}
+
+static const text_t *
+_graph_text(graph_t *graph, uint64_t addr)
+{
+	for(unsigned i = 0; i < graph->n_texts; i++)
+	{
+		const text_t *text = &graph->texts[i];
+
+		if( (addr >= text->addr) && (addr < text->addr + text->size) )
+		{
+			return text;
+		}
+	}
+
+	return NULL;
+}
+
+static const char *
+_graph_slot(graph_t *graph, uint64_t addr)
+{
+	const slot_t key = {
+		.addr = addr
+	};
+	const slot_t *slot = bsearch(&key, graph->slots, graph->n_slots,
+		sizeof(slot_t), _slot_cmp);
+
+	return slot ? slot->name : NULL;
+}
+
+static bool
+_graph_visit(graph_t *graph, uint64_t addr)
+{
+	const unsigned mask = GRAPH_VISITED - 1;
+
+	if(graph->n_visited >= GRAPH_VISITED/2)
+	{
+		return false; // table full, stop exploring
+	}
+
+	for(unsigned i = addr & mask; ; i = (i + 1) & mask)
+	{
+		if(graph->visited[i] == addr)
+		{
+			return false; // already visited
+		}
+		else if(graph->visited[i] == 0)
+		{
+			graph->visited[i] = addr;
+			graph->n_visited++;
+			return true;
+		}
+	}
+}
+
+static void
+_graph_push(graph_t *graph, uint64_t addr)
+{
+	if(!addr || !_graph_visit(graph, addr))
+	{
+		return;
+	}
+
+	uint64_t *stack = realloc(graph->stack, (graph->n_stack + 1) * sizeof(uint64_t));
+	if(stack)
+	{
+		graph->stack = stack;
+		graph->stack[graph->n_stack++] = addr;
+	}
+}
+
+static target_t
+_graph_target(graph_t *graph, const cs_insn *insn, uint64_t *target)
+{
+	if(graph->machine == EM_X86_64)
+	{
+		const cs_x86 *x86 = &insn->detail->x86;
+
+		if(x86->op_count != 1)
+		{
+			return TARGET_NONE;
+		}
+
+		const cs_x86_op *op = &x86->operands[0];
+
+		if(op->type == X86_OP_IMM)
+		{
+			*target = op->imm;
+			return TARGET_DIRECT;
+		}
+		else if( (op->type == X86_OP_MEM) && (op->mem.base == X86_REG_RIP)
+			&& (op->mem.index == X86_REG_INVALID) )
+		{
+			*target = insn->address + insn->size + op->mem.disp;
+			return TARGET_SLOT;
+		}
+	}
+	else if(graph->machine == EM_AARCH64)
+	{
+		const cs_arm64 *arm64 = &insn->detail->arm64;
+
+		if(arm64->op_count < 1)
+		{
+			return TARGET_NONE;
+		}
+
+		const cs_arm64_op *op = &arm64->operands[arm64->op_count - 1];
+
+		if(op->type == ARM64_OP_IMM)
+		{
+			*target = op->imm;
+			return TARGET_DIRECT;
+		}
+		else if( (op->type == ARM64_OP_REG) && graph->slot.addr
+			&& (op->reg == graph->slot.reg) )
+		{
+			*target = graph->slot.addr;
+			return TARGET_SLOT;
+		}
+	}
+
+	return TARGET_NONE;
+}
+
+static void
+_graph_track(graph_t *graph, const cs_insn *insn)
+{
+	if(graph->machine != EM_AARCH64)
+	{
+		return;
+	}
+
+	// follow 'adrp xN, page; ldr xM, [xN, #off]; br/blr xM' sequences
+	const cs_arm64 *arm64 = &insn->detail->arm64;
+
+	if( (insn->id == ARM64_INS_ADRP) && (arm64->op_count == 2) )
+	{
+		graph->page.reg = arm64->operands[0].reg;
+		graph->page.addr = arm64->operands[1].imm;
+	}
+	else if( (insn->id == ARM64_INS_LDR) && (arm64->op_count == 2)
+		&& (arm64->operands[1].type == ARM64_OP_MEM)
+		&& graph->page.addr
+		&& (arm64->operands[1].mem.base == graph->page.reg) )
+	{
+		graph->slot.reg = arm64->operands[0].reg;
+		graph->slot.addr = graph->page.addr + arm64->operands[1].mem.disp;
+	}
+}
+
+static bool
+_graph_unconditional(graph_t *graph, const cs_insn *insn)
+{
+	if(graph->machine == EM_X86_64)
+	{
+		return (insn->id == X86_INS_JMP) || (insn->id == X86_INS_LJMP);
+	}
+	else if(graph->machine == EM_AARCH64)
+	{
+		const arm64_cc cc = insn->detail->arm64.cc;
+
+		return (insn->id == ARM64_INS_BR)
+			|| ( (insn->id == ARM64_INS_B)
+				&& ( (cc == ARM64_CC_INVALID) || (cc == ARM64_CC_AL) ) );
+	}
+
+	return true;
+}
+
+static bool
+_graph_terminal(graph_t *graph, const cs_insn *insn)
+{
+	if(cs_insn_group(graph->handle, insn, CS_GRP_RET)
+		|| cs_insn_group(graph->handle, insn, CS_GRP_IRET) )
+	{
+		return true;
+	}
+
+	if(graph->machine == EM_X86_64)
+	{
+		return (insn->id == X86_INS_UD2) || (insn->id == X86_INS_HLT)
+			|| (insn->id == X86_INS_INT3);
+	}
+	else if(graph->machine == EM_AARCH64)
+	{
+		return insn->id == ARM64_INS_BRK;
+	}
+
+	return false;
+}
+
+static bool
+_graph_fpenv(graph_t *graph, const cs_insn *insn)
+{
+	if(graph->machine == EM_X86_64)
+	{
+		return (insn->id == X86_INS_LDMXCSR) || (insn->id == X86_INS_VLDMXCSR);
+	}
+	else if(graph->machine == EM_AARCH64)
+	{
+		return (insn->id == ARM64_INS_MSR) && !strncmp(insn->op_str, "fpcr", 4);
+	}
+
+	return false;
+}
+
+static uint64_t
+_graph_plt(graph_t *graph, const text_t *text, uint64_t addr)
+{
+	const uint8_t *code = text->buf + (addr - text->addr);
+	size_t size = text->size - (addr - text->addr);
+	uint64_t pc = addr;
+	uint64_t slot = 0;
+
+	// probed from within a walk, whose adrp/ldr tracking must survive
+	const track_t page = graph->page;
+	const track_t prev = graph->slot;
+
+	memset(&graph->page, 0x0, sizeof(graph->page));
+	memset(&graph->slot, 0x0, sizeof(graph->slot));
+
+	// a PLT stub dereferences its GOT slot within its first few instructions
+	for(unsigned i = 0;
+		(i < 4) && cs_disasm_iter(graph->handle, &code, &size, &pc, graph->stub);
+		i++)
+	{
+		const cs_insn *insn = graph->stub;
+		uint64_t target = 0;
+
+		_graph_track(graph, insn);
+
+		if(graph->machine == EM_AARCH64)
+		{
+			if(graph->slot.addr)
+			{
+				slot = graph->slot.addr;
+				break;
+			}
+		}
+		else if(cs_insn_group(graph->handle, insn, CS_GRP_JUMP)
+			&& (_graph_target(graph, insn, &target) == TARGET_SLOT) )
+		{
+			slot = target;
+			break;
+		}
+	}
+
+	graph->page = page;
+	graph->slot = prev;
+
+	return slot;
+}
+
+static bool
+_graph_check(graph_t *graph, const char *name)
+{
+	static const char *noreturn [] = {
+		"abort",
+		"exit",
+		"_exit",
+		"__assert_fail",
+		"__stack_chk_fail",
+		"__chk_fail",
+		"__fortify_fail",
+		"__cxa_throw",
+		"__cxa_rethrow",
+		"_Unwind_Resume",
+		"_ZSt9terminatev"
+	};
+	const unsigned n_noreturn = sizeof(noreturn) / sizeof(const char *);
+
+	if(!name)
+	{
+		return false;
+	}
+
+	for(unsigned j = 0; j < graph->n_blacklist; j++)
+	{
+		const char *entry = graph->blacklist[j];
+		const size_t len = strlen(entry);
+
+		if(strncmp(name, entry, len))
+		{
+			continue;
+		}
+
+		// mangled C++ entries match whatever parameter types follow, others
+		// match exactly, but for a symbol version (e.g. malloc@GLIBC_2.2.5)
+		if(strncmp(entry, "_Z", 2) && (name[len] != '\0') && (name[len] != '@') )
+		{
+			continue;
+		}
+
+		bool seen = false;
+
+		for(unsigned i = 0; i < graph->n_seen; i++)
+		{
+			if(!strcmp(name, graph->seen[i]))
+			{
+				seen = true;
+				break;
+			}
+		}
+
+		if(!seen)
+		{
+			const char **seens = realloc(graph->seen, (graph->n_seen + 1) * sizeof(const char *));
+			if(seens)
+			{
+				graph->seen = seens;
+				graph->seen[graph->n_seen++] = name;
+
+				if(graph->n_seen <= 11)
+				{
+					_append_to(graph->symbols, (graph->n_seen == 11)
+						? "... there is more, but the rest is being truncated"
+						: name);
+				}
+			}
+		}
+
+		break;
+	}
+
+	for(unsigned j = 0; j < n_noreturn; j++)
+	{
+		if(!strcmp(name, noreturn[j]))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static bool
+_graph_branch(graph_t *graph, target_t type, uint64_t target)
+{
+	if(type == TARGET_SLOT)
+	{
+		return _graph_check(graph, _graph_slot(graph, target));
+	}
+	else if(type == TARGET_DIRECT)
+	{
+		const text_t *text = _graph_text(graph, target);
+
+		if(!text)
+		{
+			return false;
+		}
+		else if(text->plt)
+		{
+			return _graph_check(graph, _graph_slot(graph,
+				_graph_plt(graph, text, target)));
+		}
+
+		_graph_push(graph, target);
+	}
+
+	return false;
+}
+
+static void
+_graph_walk(graph_t *graph, uint64_t addr)
+{
+	const text_t *text = _graph_text(graph, addr);
+
+	if(!text || text->plt)
+	{
+		return;
+	}
+
+	const uint8_t *code = text->buf + (addr - text->addr);
+	size_t size = text->size - (addr - text->addr);
+	uint64_t pc = addr;
+
+	memset(&graph->page, 0x0, sizeof(graph->page));
+	memset(&graph->slot, 0x0, sizeof(graph->slot));
+
+	// decode linearly until the end of this basic block chain
+	while(graph->budget
+		&& cs_disasm_iter(graph->handle, &code, &size, &pc, graph->insn))
+	{
+		const cs_insn *insn = graph->insn;
+		const bool is_call = cs_insn_group(graph->handle, insn, CS_GRP_CALL);
+		const bool is_jump = cs_insn_group(graph->handle, insn, CS_GRP_JUMP);
+		uint64_t target = 0;
+
+		graph->budget--;
+		_graph_track(graph, insn);
+
+		if(_graph_fpenv(graph, insn))
+		{
+			graph->fpenv = true;
+		}
+
+		if(is_call || is_jump)
+		{
+			const target_t type = _graph_target(graph, insn, &target);
+			const uint64_t next = insn->address + insn->size;
+
+			if(_graph_branch(graph, type, target))
+			{
+				break; // call to a noreturn function
+			}
+
+			if(is_jump && _graph_unconditional(graph, insn))
+			{
+				break;
+			}
+
+			if(is_jump && !_graph_visit(graph, next))
+			{
+				break; // fall-through block has been visited already
+			}
+		}
+		else if(_graph_terminal(graph, insn))
+		{
+			break;
+		}
+	}
+}
+
+static bool
+_graph_load(graph_t *graph, Elf *elf)
+{
+	GElf_Ehdr ehdr;
+	size_t shstrndx;
+
+	if(!gelf_getehdr(elf, &ehdr) || elf_getshdrstrndx(elf, &shstrndx))
+	{
+		return false;
+	}
+
+	graph->machine = ehdr.e_machine;
+
+	for(Elf_Scn *scn = elf_nextscn(elf, NULL);
+		scn;
+		scn = elf_nextscn(elf, scn))
+	{
+		GElf_Shdr shdr;
+		memset(&shdr, 0x0, sizeof(GElf_Shdr));
+		gelf_getshdr(scn, &shdr);
+
+		if( (shdr.sh_type == SHT_PROGBITS) && (shdr.sh_flags & SHF_EXECINSTR) )
+		{
+			// found executable code
+			Elf_Data *data = elf_getdata(scn, NULL);
+			const char *name = elf_strptr(elf, shstrndx, shdr.sh_name);
+
+			if(!data || !data->d_buf)
+			{
+				continue;
+			}
+
+			text_t *texts = realloc(graph->texts, (graph->n_texts + 1) * sizeof(text_t));
+			if(!texts)
+			{
+				return false;
+			}
+
+			graph->texts = texts;
+			graph->texts[graph->n_texts++] = (text_t){
+				.addr = shdr.sh_addr,
+				.size = data->d_size,
+				.buf = data->d_buf,
+				.plt = name && !strncmp(name, ".plt", 4)
+			};
+		}
+		else if(shdr.sh_type == SHT_RELA)
+		{
+			// found relocations, collect GOT slots of imported functions
+			Elf_Data *data = elf_getdata(scn, NULL);
+			Elf_Scn *sym_scn = elf_getscn(elf, shdr.sh_link);
+			const unsigned count = shdr.sh_size / shdr.sh_entsize;
+
+			GElf_Shdr sym_shdr;
+			memset(&sym_shdr, 0x0, sizeof(GElf_Shdr));
+
+			if(!data || !sym_scn || !gelf_getshdr(sym_scn, &sym_shdr))
+			{
+				continue;
+			}
+
+			Elf_Data *sym_data = elf_getdata(sym_scn, NULL);
+
+			for(unsigned i = 0; i < count; i++)
+			{
+				GElf_Rela rela;
+				memset(&rela, 0x0, sizeof(GElf_Rela));
+				gelf_getrela(data, i, &rela);
+
+				const unsigned type = GELF_R_TYPE(rela.r_info);
+				const bool is_slot = (graph->machine == EM_X86_64)
+					? (type == R_X86_64_JUMP_SLOT) || (type == R_X86_64_GLOB_DAT)
+					: (type == R_AARCH64_JUMP_SLOT) || (type == R_AARCH64_GLOB_DAT);
+
+				if(!is_slot || !GELF_R_SYM(rela.r_info))
+				{
+					continue;
+				}
+
+				GElf_Sym sym;
+				memset(&sym, 0x0, sizeof(GElf_Sym));
+				gelf_getsym(sym_data, GELF_R_SYM(rela.r_info), &sym);
+
+				const char *name = elf_strptr(elf, sym_shdr.sh_link, sym.st_name);
+				if(!name)
+				{
+					continue;
+				}
+
+				slot_t *slots = realloc(graph->slots, (graph->n_slots + 1) * sizeof(slot_t));
+				if(!slots)
+				{
+					return false;
+				}
+
+				graph->slots = slots;
+				graph->slots[graph->n_slots++] = (slot_t){
+					.addr = rela.r_offset,
+					.name = name
+				};
+			}
+		}
+	}
+
+	qsort(graph->slots, graph->n_slots, sizeof(slot_t), _slot_cmp);
+
+	return true;
+}
+
+static uint64_t
+_graph_base(Elf *elf)
+{
+	const uint64_t page = sysconf(_SC_PAGESIZE);
+	uint64_t base = UINT64_MAX;
+	size_t n_phdrs = 0;
+
+	elf_getphdrnum(elf, &n_phdrs);
+
+	// the lowest loaded segment is mapped to dli_fbase
+	for(unsigned i = 0; i < n_phdrs; i++)
+	{
+		GElf_Phdr phdr;
+		memset(&phdr, 0x0, sizeof(GElf_Phdr));
+		gelf_getphdr(elf, i, &phdr);
+
+		if( (phdr.p_type == PT_LOAD) && (phdr.p_vaddr < base) )
+		{
+			base = phdr.p_vaddr;
+		}
+	}
+
+	return (base == UINT64_MAX) ? 0 : base & ~(page - 1);
+}
+
+static uint64_t
+_graph_relative(Elf *elf, GElf_Half machine, uint64_t slot)
+{
+	for(Elf_Scn *scn = elf_nextscn(elf, NULL);
+		scn;
+		scn = elf_nextscn(elf, scn))
+	{
+		GElf_Shdr shdr;
+		memset(&shdr, 0x0, sizeof(GElf_Shdr));
+		gelf_getshdr(scn, &shdr);
+
+		if(shdr.sh_type != SHT_RELA)
+		{
+			continue;
+		}
+
+		Elf_Data *data = elf_getdata(scn, NULL);
+		const unsigned count = shdr.sh_size / shdr.sh_entsize;
+
+		for(unsigned i = 0; data && (i < count); i++)
+		{
+			GElf_Rela rela;
+			memset(&rela, 0x0, sizeof(GElf_Rela));
+			gelf_getrela(data, i, &rela);
+
+			const unsigned type = GELF_R_TYPE(rela.r_info);
+			const bool is_relative = (machine == EM_X86_64)
+				? (type == R_X86_64_RELATIVE)
+				: (type == R_AARCH64_RELATIVE);
+
+			if(is_relative && (rela.r_offset == slot) )
+			{
+				return rela.r_addend;
+			}
+		}
+	}
+
+	return 0;
+}
+
+static bool
+_graph_symbol(Elf *elf, const char *name)
+{
+	for(Elf_Scn *scn = elf_nextscn(elf, NULL);
+		scn;
+		scn = elf_nextscn(elf, scn))
+	{
+		GElf_Shdr shdr;
+		memset(&shdr, 0x0, sizeof(GElf_Shdr));
+		gelf_getshdr(scn, &shdr);
+
+		if( (shdr.sh_type != SHT_SYMTAB) && (shdr.sh_type != SHT_DYNSYM) )
+		{
+			continue;
+		}
+
+		Elf_Data *data = elf_getdata(scn, NULL);
+		const unsigned count = shdr.sh_size / shdr.sh_entsize;
+
+		for(unsigned i = 0; data && (i < count); i++)
+		{
+			GElf_Sym sym;
+			memset(&sym, 0x0, sizeof(GElf_Sym));
+			gelf_getsym(data, i, &sym);
+
+			const char *sym_name = elf_strptr(elf, shdr.sh_link, sym.st_name);
+
+			if(sym.st_value && sym_name && !strcmp(sym_name, name))
+			{
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+static bool
+_graph_open(graph_t *graph, Elf *elf)
+{
+	cs_arch arch = CS_ARCH_X86;
+	cs_mode mode = CS_MODE_64;
+
+	if(!_graph_load(graph, elf))
+	{
+		return false;
+	}
+
+	switch(graph->machine)
+	{
+		case EM_X86_64:
+		{
+			arch = CS_ARCH_X86;
+			mode = CS_MODE_64;
+		} break;
+		case EM_AARCH64:
+		{
+			arch = CS_ARCH_ARM64;
+			mode = CS_MODE_ARM;
+		} break;
+		default:
+		{
+			return false; // unsupported architecture
+		}
+	}
+
+	graph->budget = GRAPH_BUDGET;
+	graph->visited = calloc(GRAPH_VISITED, sizeof(uint64_t));
+	if(!graph->visited)
+	{
+		return false;
+	}
+
+	if(cs_open(arch, mode, &graph->handle) != CS_ERR_OK)
+	{
+		return false;
+	}
+
+	cs_option(graph->handle, CS_OPT_DETAIL, CS_OPT_ON);
+	graph->insn = cs_malloc(graph->handle);
+	graph->stub = cs_malloc(graph->handle);
+	if(!graph->insn || !graph->stub)
+	{
+		if(graph->insn)
+		{
+			cs_free(graph->insn, 1);
+			graph->insn = NULL;
+		}
+		if(graph->stub)
+		{
+			cs_free(graph->stub, 1);
+			graph->stub = NULL;
+		}
+		cs_close(&graph->handle);
+		return false;
+	}
+
+	return true;
+}
+
+static void
+_graph_close(graph_t *graph)
+{
+	if(graph->insn)
+	{
+		cs_free(graph->insn, 1);
+		cs_free(graph->stub, 1);
+		cs_close(&graph->handle);
+	}
+
+	free(graph->texts);
+	free(graph->slots);
+	free(graph->stack);
+	free(graph->visited);
+	free(graph->seen);
+}
+
+static void
+_graph_run(graph_t *graph)
+{
+	while(graph->n_stack && graph->budget)
+	{
+		_graph_walk(graph, graph->stack[--graph->n_stack]);
+	}
+}
+
+bool
+test_realtime_calls(const uintptr_t *roots, unsigned n_roots,
+	const char *const *blacklist, unsigned n_blacklist, char **symbols)
+{
+	Dl_info info;
+	memset(&info, 0x0, sizeof(Dl_info));
+
+	if(!n_roots || !dladdr((const void *)roots[0], &info) || !info.dli_fname)
+	{
+		return true;
+	}
+
+	graph_t graph;
+	memset(&graph, 0x0, sizeof(graph_t));
+	graph.blacklist = blacklist;
+	graph.n_blacklist = n_blacklist;
+	graph.symbols = symbols;
+
+	const int fd = open(info.dli_fname, O_RDONLY);
+	if(fd != -1)
+	{
+		elf_version(EV_CURRENT);
+
+		Elf *elf = elf_begin(fd, ELF_C_READ, NULL);
+		if(elf)
+		{
+			if(_graph_open(&graph, elf))
+			{
+				const uint64_t base = _graph_base(elf);
+
+				for(unsigned i = 0; i < n_roots; i++)
+				{
+					Dl_info root;
+					memset(&root, 0x0, sizeof(Dl_info));
+
+					// only follow entry points from within this very binary
+					if(roots[i] && dladdr((const void *)roots[i], &root)
+						&& (root.dli_fbase == info.dli_fbase) )
+					{
+						_graph_push(&graph, roots[i]
+							- (uintptr_t)info.dli_fbase + base);
+					}
+				}
+
+				_graph_run(&graph);
+			}
+
+			elf_end(elf);
+		}
+		close(fd);
+	}
+
+	const bool passed = (graph.n_seen == 0);
+
+	_graph_close(&graph);
+
+	return passed;
+}
+
+static void
+_graph_inits(graph_t *graph, Elf *elf)
+{
+	for(Elf_Scn *scn = elf_nextscn(elf, NULL);
+		scn;
+		scn = elf_nextscn(elf, scn))
+	{
+		GElf_Shdr shdr;
+		memset(&shdr, 0x0, sizeof(GElf_Shdr));
+		gelf_getshdr(scn, &shdr);
+
+		if(shdr.sh_type != SHT_INIT_ARRAY)
+		{
+			continue;
+		}
+
+		// found constructors
+		Elf_Data *data = elf_getdata(scn, NULL);
+		if(!data || !data->d_buf)
+		{
+			continue;
+		}
+
+		const unsigned count = data->d_size / sizeof(uint64_t);
+		const uint64_t *ptrs = data->d_buf;
+
+		for(unsigned i = 0; i < count; i++)
+		{
+			const uint64_t slot = shdr.sh_addr + i*sizeof(uint64_t);
+			uint64_t addr = ptrs[i];
+
+			if(!addr) // position-independent, look up relative relocation
+			{
+				addr = _graph_relative(elf, graph->machine, slot);
+			}
+
+			_graph_push(graph, addr);
+		}
+	}
+}
+
+static const char *
+_isa_name(graph_t *graph, const cs_insn *insn, unsigned *level)
+{
+	static const struct {
+		unsigned group;
+		const char *name;
+	} x86 [] = {
+		{X86_GRP_FPU,     "x87"},
+		{X86_GRP_MMX,     "MMX"},
+		{X86_GRP_SSE1,    "SSE"},
+		{X86_GRP_SSE2,    "SSE2"},
+		{X86_GRP_SSE3,    "SSE3"},
+		{X86_GRP_SSSE3,   "SSSE3"},
+		{X86_GRP_SSE41,   "SSE4.1"},
+		{X86_GRP_SSE42,   "SSE4.2"},
+		{X86_GRP_AVX,     "AVX"},
+		{X86_GRP_FMA,     "FMA"},
+		{X86_GRP_AVX2,    "AVX2"},
+		{X86_GRP_AVX512,  "AVX-512"},
+		{X86_GRP_CDI,     "AVX-512"},
+		{X86_GRP_ERI,     "AVX-512"},
+		{X86_GRP_PFI,     "AVX-512"},
+		{X86_GRP_DQI,     "AVX-512"},
+		{X86_GRP_BWI,     "AVX-512"},
+		{X86_GRP_VLX,     "AVX-512"}
+	}, arm64 [] = {
+		{ARM64_GRP_FPARMV8, "FP"},
+		{ARM64_GRP_NEON,    "NEON"},
+		{ARM64_GRP_CRYPTO,  "Crypto"}
+	};
+	const unsigned n_x86 = sizeof(x86) / sizeof(x86[0]);
+	const unsigned n_arm64 = sizeof(arm64) / sizeof(arm64[0]);
+
+	const char *name = NULL;
+
+	if(graph->machine == EM_X86_64)
+	{
+		for(unsigned i = 0; i < n_x86; i++)
+		{
+			if(cs_insn_group(graph->handle, insn, x86[i].group))
+			{
+				name = x86[i].name;
+				*level = i + 1;
+			}
+		}
+	}
+	else if(graph->machine == EM_AARCH64)
+	{
+		for(unsigned i = 0; i < n_arm64; i++)
+		{
+			if(cs_insn_group(graph->handle, insn, arm64[i].group))
+			{
+				name = arm64[i].name;
+				*level = i + 1;
+			}
+		}
+	}
+
+	return name;
+}
+
+bool
+test_instruction_set(const char *path, isa_t *isa)
+{
+	graph_t graph;
+	memset(&graph, 0x0, sizeof(graph_t));
+	memset(isa, 0x0, sizeof(isa_t));
+
+	const int fd = open(path, O_RDONLY);
+	if(fd != -1)
+	{
+		elf_version(EV_CURRENT);
+
+		Elf *elf = elf_begin(fd, ELF_C_READ, NULL);
+		if(elf)
+		{
+			if(_graph_open(&graph, elf))
+			{
+				unsigned highest = 0;
+				unsigned n_x87 = 0;
+				unsigned n_simd = 0;
+
+				cs_option(graph.handle, CS_OPT_SKIPDATA, CS_OPT_ON);
+
+				// linear sweep over all code
+				for(unsigned i = 0; i < graph.n_texts; i++)
+				{
+					const text_t *text = &graph.texts[i];
+					const uint8_t *code = text->buf;
+					size_t size = text->size;
+					uint64_t pc = text->addr;
+
+					if(text->plt)
+					{
+						continue;
+					}
+
+					while(cs_disasm_iter(graph.handle, &code, &size, &pc, graph.insn))
+					{
+						unsigned level = 0;
+						const char *name = _isa_name(&graph, graph.insn, &level);
+
+						if( (graph.machine == EM_X86_64) && (graph.insn->id == X86_INS_CPUID) )
+						{
+							isa->cpuid = true;
+						}
+
+						if(!name)
+						{
+							continue;
+						}
+
+						if(level > highest)
+						{
+							highest = level;
+							isa->highest = name;
+						}
+
+						if(!strcmp(name, "x87"))
+						{
+							n_x87++;
+						}
+						else
+						{
+							n_simd++;
+						}
+
+						if(!strcmp(name, "AVX-512"))
+						{
+							isa->avx512 = true;
+						}
+					}
+				}
+
+				cs_option(graph.handle, CS_OPT_SKIPDATA, CS_OPT_OFF);
+
+				isa->x87_only = n_x87 && !n_simd;
+
+				// __builtin_cpu_supports and target_clones query libgcc's cpu model
+				if(!isa->cpuid)
+				{
+					isa->cpuid = _graph_symbol(elf, "__cpu_model")
+						|| _graph_symbol(elf, "__cpu_indicator_init");
+				}
+
+				// constructors altering the floating-point environment at load time
+				isa->fast_math = _graph_symbol(elf, "set_fast_math");
+				if(!isa->fast_math)
+				{
+					_graph_inits(&graph, elf);
+					_graph_run(&graph);
+
+					isa->fast_math = graph.fpenv;
+				}
+			}
+
+			elf_end(elf);
+		}
+		close(fd);
+	}
+
+	_graph_close(&graph);
+
+	return !(isa->x87_only || isa->fast_math);
+}
+#	endif
+#endif
+
+static void
+_state_set_value(const char *symbol __unused, void *data __unused,
+	const void *value __unused, uint32_t size __unused, uint32_t type __unused)
+{
+	//FIXME
+}
+
+int
+main(int argc, char **argv)
+{
+	static app_t app;
+	app.atty = isatty(1);
+	memcpy(app.limits, limits, sizeof(limits));
+	app.show = LINT_FAIL | LINT_WARN; // always report failed and warned tests
+	app.mask = LINT_FAIL; // always fail at failed tests
+	app.sequence_size = 2048; // bytes
+	const char *include_dir = NULL;
+	LilvNode *bundle_node = NULL;
+#ifdef ENABLE_ONLINE_TESTS
+	app.greet = "Dear LV2 plugin developer\n"
+		"\n"
+		"We would like to congratulate you for your efforts to have created this\n"
+		"awesome plugin for the LV2 ecosystem.\n"
+		"\n"
+		"However, we have found some minor issues where your plugin deviates from\n"
+		"the LV2 plugin specification and/or its best implementation practices.\n"
+		"By fixing those, you can make your plugin more conforming and thus likely\n"
+		"usable in more hosts and with less issues for your users.\n"
+		"\n"
+		"Kindly find below an automatically generated bug report with a summary\n"
+		"of potential issues.\n"
+		"\n"
+		"Yours sincerely\n"
+		"                                 /The unofficial LV2 inquisitorial squad/\n"
+		"\n"
+		"---\n\n";
+#endif
+
+	fprintf(stderr,
+		"%s "LV2LINT_VERSION"\n"
+		"Copyright (c) 2016-2019 Hanspeter Portner (dev@open-music-kontrollers.ch)\n"
+		"Released under Artistic License 2.0 by Open Music Kontrollers\n",
+		argv[0]);
+
+	int c;
+#ifdef ENABLE_ONLINE_TESTS
+	while( (c = getopt(argc, argv, "vhdpomg:L:Q:W:T:X:G:R:S:E:I:") ) != -1)
+#else
+	while( (c = getopt(argc, argv, "vhdpL:Q:W:T:X:G:R:S:E:I:") ) != -1)
+#endif
+	{
+		switch(c)
+		{
+			case 'v':
+				_version();
+				return 0;
+			case 'h':
+				_usage(argv);
+				return 0;
+			case 'd':
+				app.debug = true;
+				break;
+			case 'I':
+				include_dir = optarg;
+				break;
+			case 'p':
+				app.perf = true;
+				break;
+			case 'L':
+				if(!_parse_limit(&app, optarg))
+				{
+					fprintf(stderr, "Invalid limit `%s'.\n", optarg);
+					return -1;
+				}
+				break;
+			case 'Q':
+				if(!_parse_sequence_size(&app, optarg))
+				{
+					fprintf(stderr, "Invalid sequence size `%s'.\n", optarg);
+					return -1;
+				}
+				break;
+			case 'W':
+				app.wcet_dir = optarg;
+				break;
+			case 'G':
+				app.fingerprint_dir = optarg;
+				break;
+			case 'R':
+				app.profile_dir = optarg;
+				break;
+			case 'T':
+				if(!_parse_threads(&app, optarg))
+				{
+					fprintf(stderr, "Invalid number of threads `%s'.\n", optarg);
+					return -1;
+				}
+				break;
+			case 'X':
+				if(!_parse_stressors(&app, optarg))
+				{
+					fprintf(stderr, "Invalid number of stressors `%s'.\n", optarg);
+					return -1;
+				}
+				break;
+#ifdef ENABLE_ONLINE_TESTS
+			case 'o':
+				app.online = true;
+				break;
+			case 'm':
+				app.mailto = true;
+				app.atty = false;
+				break;
+			case 'g':
+				app.greet = optarg;
+				break;
+#endif
+			case 'S':
+				if(!strcmp(optarg, "warn"))
+				{
+					app.show |= LINT_WARN;
+				}
+				else if(!strcmp(optarg, "note"))
+				{
+					app.show |= LINT_NOTE;
+				}
+				else if(!strcmp(optarg, "pass"))
+				{
+					app.show |= LINT_PASS;
+				}
+				else if(!strcmp(optarg, "all"))
+				{
+					app.show |= (LINT_WARN | LINT_NOTE | LINT_PASS);
+				}
+
+				else if(!strcmp(optarg, "nowarn"))
+				{
+					app.show &= ~LINT_WARN;
+				}
 				else if(!strcmp(optarg, "nonote"))
 				{
 					app.show &= ~LINT_NOTE;
@@ -921,9 +3138,13 @@ main(int argc, char **argv)
 				break;
 			case '?':
 #ifdef ENABLE_ONLINE_TESTS
-				if( (optopt == 'S') || (optopt == 'E') || (optopt == 'g') )
+				if( (optopt == 'S') || (optopt == 'E') || (optopt == 'L') || (optopt == 'Q')
+					|| (optopt == 'W') || (optopt == 'T') || (optopt == 'X') || (optopt == 'G')
+					|| (optopt == 'R') || (optopt == 'g') )
 #else
-				if( (optopt == 'S') || (optopt == 'E') )
+				if( (optopt == 'S') || (optopt == 'E') || (optopt == 'L') || (optopt == 'Q')
+					|| (optopt == 'W') || (optopt == 'T') || (optopt == 'X') || (optopt == 'G')
+					|| (optopt == 'R') )
 #endif
 					fprintf(stderr, "Option `-%c' requires an argument.\n", optopt);
 				else if(isprint(optopt))
@@ -942,6 +3163,17 @@ main(int argc, char **argv)
 		return -1;
 	}
 
+	// crash-prone tests re-execute us with the same options for a single plugin
+	app.argv = argv;
+	app.argn = optind;
+
+	const char *helper = getenv("LV2LINT_HELPER");
+	if(helper && !_parse_helper(&app, helper))
+	{
+		fprintf(stderr, "Invalid helper `%s'.\n", helper);
+		return -1;
+	}
+
 #ifdef ENABLE_ONLINE_TESTS
 	app.curl = curl_easy_init();
 	if(!app.curl)
@@ -973,10 +3205,20 @@ main(int argc, char **argv)
 
 	LV2_URID_Map *map = mapper_get_map(mapper);
 	LV2_URID_Unmap *unmap = mapper_get_unmap(mapper);
+
+	// echo plugin messages under -d, as they are otherwise only summarized
+	if(!lv2lint_log_init(app.debug, map->map(map->handle, LV2_LOG__Error),
+		map->map(map->handle, LV2_LOG__Warning)))
+		return -1;
+
 	LV2_Worker_Schedule sched = {
 		.handle = &app,
 		.schedule_work = _sched
 	};
+	LV2_URID_Map map_tagged = {
+		.handle = &app,
+		.map = _map
+	};
 	LV2_Log_Log log = {
 		.handle = &app,
 		.printf = _printf,
@@ -993,7 +3235,7 @@ main(int argc, char **argv)
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wdeprecated-declarations"
 	LV2_URI_Map_Feature urimap = {
-		.callback_data = map,
+		.callback_data = &map_tagged,
 		.uri_to_id = _uri_to_id
 	};
 #pragma GCC diagnostic pop
@@ -1016,7 +3258,7 @@ main(int argc, char **argv)
 	const int32_t bufsz_min_block_length = 256;
 	const int32_t bufsz_max_block_length = 256;
 	const int32_t bufsz_nominal_block_length = 256;
-	const int32_t bufsz_sequence_size = 2048;
+	const int32_t bufsz_sequence_size = app.sequence_size;
 
 	const LV2_Options_Option opts_sampleRate = {
 		.key = param_sampleRate,
@@ -1070,7 +3312,7 @@ main(int argc, char **argv)
 
 	const LV2_Feature feat_map = {
 		.URI = LV2_URID__map,
-		.data = map
+		.data = &map_tagged
 	};
 	const LV2_Feature feat_unmap = {
 		.URI = LV2_URID__unmap,
@@ -1136,6 +3378,11 @@ main(int argc, char **argv)
 		.data = &queue_draw
 	};
 
+	app.map = map;
+	app.unmap = unmap;
+	app.sample_rate = param_sample_rate;
+	app.block_length = bufsz_max_block_length;
+
 	int ret = 0;
 	const LilvPlugin *plugins = lilv_world_get_all_plugins(app.world);
 	if(plugins)
@@ -1215,6 +3462,8 @@ main(int argc, char **argv)
 
 						features[f++] = NULL; // sentinel
 						assert(f <= MAX_FEATURES);
+
+						app.features = features;
 					}
 
 					// populate required option list
@@ -1291,7 +3540,46 @@ main(int argc, char **argv)
 						lilv_node_as_uri(lilv_plugin_get_uri(app.plugin)),
 						colors[app.atty][ANSI_COLOR_RESET]);
 
-					app.instance = lilv_plugin_instantiate(app.plugin, param_sample_rate, features);
+					memset(&app.stats, 0x0, sizeof(app.stats));
+					lv2lint_callback_reset(&app);
+					lv2lint_log_reset();
+					lv2lint_log_pause(true); // keep the drainer's allocations out
+					const int64_t rss = lv2lint_mem_rss(); // allocates itself
+					lv2lint_mem_reset();
+
+#if !defined(_WIN32)
+					// load plugin binary ourselves to tell dlopen and instantiation apart,
+					// lazily like lilv does, to leave the cost of binding to the first run()
+					void *lib = NULL;
+					if(app.perf)
+					{
+						const LilvNode *node = lilv_plugin_get_library_uri(app.plugin);
+						char *path = node && lilv_node_is_uri(node)
+							? lilv_file_uri_parse(lilv_node_as_uri(node), NULL)
+							: NULL;
+
+						if(path)
+						{
+							const uint64_t t0 = lv2lint_now();
+							lib = dlopen(path, RTLD_LAZY);
+							app.stats.dlopen = lv2lint_now() - t0;
+
+							lilv_free(path);
+						}
+					}
+#endif
+
+					{
+						const uint64_t t0 = lv2lint_now();
+						lv2lint_phase_set(PHASE_INSTANTIATE);
+						app.instance = lilv_plugin_instantiate(app.plugin, param_sample_rate, features);
+						lv2lint_phase_set(PHASE_OTHER);
+						app.stats.instantiation = lv2lint_now() - t0;
+					}
+
+					app.stats.rss = lv2lint_mem_rss() - rss;
+					lv2lint_mem_get(&app.stats.allocations, &app.stats.heap);
+					lv2lint_log_pause(false);
 
 					if(app.instance)
 					{
@@ -1321,6 +3609,12 @@ main(int argc, char **argv)
 						}
 					}
 
+					if(app.helper)
+					{
+						// the plugin may be left in any state, thus do not tear it down
+						_exit(helper_plugin(&app) ? 0 : 1);
+					}
+
 					if(!test_plugin(&app))
 					{
 #ifdef ENABLE_ONLINE_TESTS // only print mailto strings if errors were encountered
@@ -1414,7 +3708,15 @@ main(int argc, char **argv)
 						app.opts_iface = NULL;
 					}
 
+#if !defined(_WIN32)
+					if(lib)
+					{
+						dlclose(lib);
+					}
+#endif
+
 					app.plugin = NULL;
+					app.features = NULL;
 
 				}
 				else
@@ -1444,10 +3746,15 @@ main(int argc, char **argv)
 		lilv_node_free(bundle_node);
 	}
 
+	lv2lint_log_deinit();
 	mapper_free(mapper);
 
 	lilv_world_free(app.world);
 
+#ifdef ENABLE_ELF_TESTS
+	free_dependencies(&app);
+#endif
+
 #ifdef ENABLE_ONLINE_TESTS
 	curl_easy_cleanup(app.curl);
 #endif
@@ -1455,6 +3762,185 @@ main(int argc, char **argv)
 	return ret;
 }
 
+lint_t
+lv2lint_limit(app_t *app, limit_id_t id, double val)
+{
+	const limit_t *limit = &app->limits[id];
+
+	if(val >= limit->fail)
+	{
+		return LINT_FAIL;
+	}
+	else if(val >= limit->warn)
+	{
+		return LINT_WARN;
+	}
+
+	return LINT_NOTE;
+}
+
+const ret_t *
+lv2lint_grade(app_t *app, lint_t lnt, const ret_t *rets)
+{
+	// rets are ordered note, limit exceeded, the latter at the graded level,
+	// which is stored with the test's result like its urn
+	const lint_t grade = (lnt & LINT_FAIL)
+		? LINT_FAIL
+		: (lnt & LINT_WARN)
+			? LINT_WARN
+			: LINT_NOTE;
+
+	*app->lnt = grade;
+
+	return (grade == LINT_NOTE)
+		? &rets[0]
+		: &rets[1];
+}
+
+#if defined(__linux__)
+pid_t
+lv2lint_helper_spawn(app_t *app, helper_t helper, int *fd)
+{
+	int fds [2];
+	pid_t pid = -1;
+
+	if(pipe(fds) == -1)
+	{
+		return -1;
+	}
+
+	// only the write end is inherited
+	fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+
+	char env [64];
+	snprintf(env, sizeof(env), "LV2LINT_HELPER=%s:%d", helpers[helper], fds[1]);
+
+	unsigned n_environ = 0;
+	while(environ[n_environ])
+	{
+		n_environ++;
+	}
+
+	char **envp = calloc(n_environ + 2, sizeof(char *));
+	char **argv = calloc(app->argn + 2, sizeof(char *));
+	posix_spawn_file_actions_t actions;
+
+	if(envp && argv && !posix_spawn_file_actions_init(&actions))
+	{
+		unsigned n_envp = 0;
+		for(unsigned i = 0; i < n_environ; i++)
+		{
+			if(strncmp(environ[i], "LV2LINT_HELPER=", 15))
+			{
+				envp[n_envp++] = environ[i];
+			}
+		}
+		envp[n_envp] = env;
+
+		// same options, current plugin only
+		for(int i = 0; i < app->argn; i++)
+		{
+			argv[i] = app->argv[i];
+		}
+		argv[app->argn] = (char *)lilv_node_as_uri(lilv_plugin_get_uri(app->plugin));
+
+		// results go through the pipe only
+		posix_spawn_file_actions_addopen(&actions, STDOUT_FILENO, "/dev/null",
+			O_WRONLY, 0);
+		posix_spawn_file_actions_addopen(&actions, STDERR_FILENO, "/dev/null",
+			O_WRONLY, 0);
+
+		if(posix_spawn(&pid, "/proc/self/exe", &actions, NULL, argv, envp))
+		{
+			pid = -1;
+		}
+
+		posix_spawn_file_actions_destroy(&actions);
+	}
+
+	free(envp);
+	free(argv);
+	close(fds[1]);
+
+	if(pid == -1)
+	{
+		close(fds[0]);
+		return -1;
+	}
+
+	*fd = fds[0];
+
+	return pid;
+}
+
+bool
+lv2lint_helper_read(int fd, void *buf, size_t size)
+{
+	uint8_t *dst = buf;
+
+	while(size)
+	{
+		const ssize_t n = read(fd, dst, size);
+
+		if(n > 0)
+		{
+			dst += n;
+			size -= n;
+		}
+		else if( (n == -1) && (errno == EINTR) )
+		{
+			continue;
+		}
+		else
+		{
+			return false; // helper has gone
+		}
+	}
+
+	return true;
+}
+
+bool
+lv2lint_helper_write(app_t *app, const void *buf, size_t size)
+{
+	const uint8_t *src = buf;
+
+	while(size)
+	{
+		const ssize_t n = write(app->helper_fd, src, size);
+
+		if(n > 0)
+		{
+			src += n;
+			size -= n;
+		}
+		else if( (n == -1) && (errno == EINTR) )
+		{
+			continue;
+		}
+		else
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool
+lv2lint_helper_wait(pid_t pid, int *status)
+{
+	pid_t res;
+
+	while( ( (res = waitpid(pid, status, 0)) == -1) && (errno == EINTR) )
+	{
+		// interrupted, try again
+	}
+
+	return res == pid;
+}
+#endif
+
 int
 lv2lint_vprintf(app_t *app, const char *fmt, va_list args)
 {
@@ -1647,7 +4133,7 @@ lv2lint_report(app_t *app, const test_t *test, res_t *res, bool show_passes, boo
 			}
 		}
 
-		switch(ret->lnt & app->show)
+		switch(res->lnt & app->show)
 		{
 			case LINT_FAIL:
 				_report_body(app, "FAIL", ANSI_COLOR_RED, test, ret, repl, docu);
@@ -1672,7 +4158,7 @@ lv2lint_report(app_t *app, const test_t *test, res_t *res, bool show_passes, boo
 
 		if(flag && *flag)
 		{
-			*flag = (ret->lnt & app->mask) ? false : true;
+			*flag = (res->lnt & app->mask) ? false : true;
 		}
 	}
 	else if(show_passes)
@@ -18,12 +18,20 @@
 #ifndef _LV2LINT_H
 #define _LV2LINT_H
 
+#include <stdio.h>
 #include <unistd.h> // isatty
 #include <string.h>
 #include <stdlib.h>
+#include <time.h>
+#include <stdatomic.h>
+#include <setjmp.h>
+#if !defined(_WIN32)
+#	include <sys/resource.h>
+#endif
 
 #include <lilv/lilv.h>
 
+#include <lv2/lv2plug.in/ns/ext/atom/forge.h>
 #include <lv2/lv2plug.in/ns/ext/worker/worker.h>
 #include <lv2/lv2plug.in/ns/ext/state/state.h>
 #include <lv2/lv2plug.in/ns/ext/options/options.h>
@@ -63,6 +71,10 @@ typedef struct _app_t app_t;
 typedef struct _test_t test_t;
 typedef struct _ret_t ret_t;
 typedef struct _res_t res_t;
+typedef struct _limit_t limit_t;
+typedef struct _run_t run_t;
+typedef struct _run_port_t run_port_t;
+typedef struct _run_queue_t run_queue_t;
 typedef const ret_t *(*test_cb_t)(app_t *app);
 
 typedef enum _lint_t {
@@ -72,6 +84,278 @@ typedef enum _lint_t {
 	LINT_PASS     = (1 << 4)
 } lint_t;
 
+typedef enum _limit_id_t {
+	LIMIT_DLOPEN,
+	LIMIT_INSTANTIATION,
+	LIMIT_RSS,
+	LIMIT_HEAP,
+	LIMIT_ALLOCATIONS,
+	LIMIT_LOAD_COST,
+	LIMIT_LIBRARIES,
+	LIMIT_LIBRARY_SIZE,
+	LIMIT_PATCH_LATENCY,
+	LIMIT_PATCH_COST,
+	LIMIT_EVENT_COST,
+	LIMIT_SWEEP_SPIKE,
+	LIMIT_WCET,
+	LIMIT_LATENCY_ERROR,
+	LIMIT_SCALING_LOSS,
+	LIMIT_SPLIT_ERROR,
+	LIMIT_FINGERPRINT,
+	LIMIT_INSTRUCTIONS,
+	LIMIT_FIRST_RUN,
+	LIMIT_DEADLINE,
+	LIMIT_ALIGNMENT,
+	LIMIT_IDLE_COST,
+	LIMIT_LOG_RATE,
+
+	LIMIT_MAX
+} limit_id_t;
+
+struct _limit_t {
+	const char *id;
+	double warn;
+	double fail;
+};
+
+#ifdef ENABLE_ELF_TESTS
+typedef struct _load_cost_t load_cost_t;
+typedef struct _dep_t dep_t;
+typedef struct _closure_t closure_t;
+typedef struct _sym_t sym_t;
+typedef struct _symtab_t symtab_t;
+
+struct _sym_t {
+	uint64_t addr;
+	uint64_t size;
+	char *name;
+};
+
+struct _symtab_t {
+	sym_t *syms; // function symbols sorted by address
+	unsigned n_syms;
+};
+
+struct _dep_t {
+	char *path; // canonical
+	char **needed;
+	unsigned n_needed;
+	char *rpath;
+	char *runpath;
+	uint64_t size; // bytes mapped
+	unsigned machine;
+	int elf_class;
+	bool valid;
+};
+
+struct _closure_t {
+	unsigned n_libraries;
+	uint64_t size; // bytes mapped, including plugin binary
+	char *unresolved;
+	char *blacklisted;
+};
+
+struct _load_cost_t {
+	unsigned relative;
+	unsigned irelative;
+	unsigned symbolic;
+	unsigned interposable; // symbolic relocations against own symbols
+	unsigned tls_dynamic; // global/local-dynamic TLS model
+	unsigned constructors;
+	unsigned jump_slots; // PLT entries, resolved on first call unless bound now
+	bool text_relocations;
+	bool symbolic_binding;
+	bool gnu_hash;
+	bool bind_now;
+	double score;
+};
+#endif
+
+#if defined(ENABLE_ELF_TESTS) && defined(ENABLE_CAPSTONE)
+typedef struct _isa_t isa_t;
+
+struct _isa_t {
+	const char *highest; // most recent instruction set extension in use
+	bool avx512;
+	bool cpuid; // queries CPU features, e.g. to dispatch AVX-512 at run-time
+	bool x87_only;
+	bool fast_math;
+};
+#endif
+
+#define RUN_MAX_FEATURES 32
+#define RUN_MAX_OPTIONS 16
+#define RUN_CANARY_SIZE 64 // bytes past each port buffer
+#define RUN_SEED 0x1d872b41 // fixed, to make generated input reproducible
+
+#if defined(RUSAGE_THREAD)
+#	define RUN_RUSAGE RUSAGE_THREAD // page faults of calling thread only
+#else
+#	define RUN_RUSAGE RUSAGE_SELF
+#endif
+
+typedef enum _phase_t {
+	PHASE_OTHER,
+	PHASE_INSTANTIATE,
+	PHASE_ACTIVATE,
+	PHASE_RUN, // audio thread, incl. work_response and end_run
+	PHASE_WORKER,
+
+	PHASE_MAX
+} phase_t;
+
+typedef enum _helper_t {
+	HELPER_NONE,
+	HELPER_LOAD, // concurrent instantiation
+	HELPER_ALIGN, // less aligned port buffers
+
+	HELPER_MAX
+} helper_t;
+
+typedef enum _callback_t {
+	CALLBACK_MAP,
+	CALLBACK_LOG,
+
+	CALLBACK_MAX
+} callback_t;
+
+typedef struct _callback_stats_t callback_stats_t;
+
+struct _callback_stats_t {
+	atomic_uint calls [PHASE_MAX];
+	atomic_flag caught; // first call from the audio thread recorded
+	unsigned thread; // of first call from the audio thread
+	char what [128]; // URI mapped or message logged
+};
+
+typedef struct _log_msg_t log_msg_t;
+typedef struct _log_stats_t log_stats_t;
+
+struct _log_msg_t {
+	uint64_t ns; // monotonic
+	unsigned thread;
+	phase_t phase;
+	LV2_URID type;
+	char txt [256];
+};
+
+struct _log_stats_t {
+	unsigned n_msgs; // drained
+	unsigned n_kept;
+	unsigned n_dropped; // on full ring buffer
+	unsigned n_run; // logged from run()
+	unsigned n_severe; // logged as error or warning
+	uint64_t run_first; // ns
+	uint64_t run_last; // ns
+};
+
+typedef enum _run_counter_t {
+	RUN_COUNTER_INSTRUCTIONS,
+	RUN_COUNTER_CYCLES,
+	RUN_COUNTER_CACHE_MISSES,
+	RUN_COUNTER_BRANCH_MISSES,
+
+	RUN_COUNTER_MAX
+} run_counter_t;
+
+typedef enum _run_port_type_t {
+	RUN_PORT_OTHER,
+	RUN_PORT_CONTROL,
+	RUN_PORT_AUDIO,
+	RUN_PORT_CV,
+	RUN_PORT_ATOM
+} run_port_type_t;
+
+typedef enum _run_signal_t {
+	RUN_SIGNAL_SILENCE,
+	RUN_SIGNAL_NOISE,
+	RUN_SIGNAL_FULL_SCALE,
+	RUN_SIGNAL_DENORMAL,
+
+	RUN_SIGNAL_MAX
+} run_signal_t;
+
+struct _run_port_t {
+	const LilvPort *port;
+	run_port_type_t type;
+	bool input;
+	void *buf;
+	size_t size; // bytes
+	size_t slack; // canary bytes past buffer
+	void *map; // mapping ending in a guard page, if any
+	size_t map_size;
+	float min; // control ports
+	float max;
+	float dflt;
+	LV2_Atom_Forge forge; // atom input ports
+	LV2_Atom_Forge_Frame frame;
+	const run_port_t *alias; // input port whose buffer is shared, if any
+};
+
+struct _run_queue_t {
+	uint8_t *buf;
+	size_t size;
+};
+
+struct _run_t {
+	app_t *app;
+	LilvInstance *instance;
+	LV2_Handle handle;
+	const LV2_Worker_Interface *work_iface;
+	bool activated;
+	uint32_t block_length; // maximal
+	uint32_t n_ports;
+	run_port_t *ports;
+	LV2_Worker_Schedule sched;
+	LV2_Feature feat_sched;
+	LV2_Feature feat_opts;
+	LV2_Options_Option opts [RUN_MAX_OPTIONS];
+	int32_t min_block_length; // as announced to this instance
+	const LV2_Feature *features [RUN_MAX_FEATURES];
+	run_queue_t jobs;
+	run_queue_t resps;
+	uint64_t t0; // start of current run() call
+	uint64_t ns; // duration of last run() call
+	uint64_t n_runs; // run() calls so far
+	int fault; // index of port whose guard page was hit, or -1
+	int overrun; // index of port written past nsamples, or -1
+	sigjmp_buf jmp; // to recover from hitting a guard page
+	struct {
+		uint64_t ns;
+		long minflt; // page faults served without I/O
+		long majflt; // page faults needing I/O
+	} first; // cold cost of very first run() call
+	int counter_fds [RUN_COUNTER_MAX]; // hardware counters of calling thread
+	bool counting;
+	uint64_t counters [RUN_COUNTER_MAX]; // of last run() call
+	struct {
+		LV2_URID atom_Chunk;
+		LV2_URID atom_Sequence;
+		LV2_URID atom_Object;
+		LV2_URID atom_Blank;
+		LV2_URID atom_Bool;
+		LV2_URID atom_Int;
+		LV2_URID atom_Long;
+		LV2_URID atom_Float;
+		LV2_URID atom_Double;
+		LV2_URID atom_String;
+		LV2_URID atom_Path;
+		LV2_URID atom_URI;
+		LV2_URID atom_URID;
+
+		LV2_URID patch_Get;
+		LV2_URID patch_Set;
+		LV2_URID patch_Put;
+		LV2_URID patch_body;
+		LV2_URID patch_property;
+		LV2_URID patch_value;
+
+		LV2_URID midi_MidiEvent;
+
+		LV2_URID bufsz_minBlockLength;
+	} urid;
+};
+
 struct _urid_t {
 	char *uri;
 };
@@ -85,6 +369,7 @@ struct _ret_t {
 
 struct _res_t {
 	const ret_t *ret;
+	lint_t lnt;
 	char *urn;
 };
 
@@ -121,8 +406,46 @@ struct _app_t {
 	urid_t *urids;
 	LV2_URID nurids;
 	char **urn;
+	lint_t *lnt;
 	bool atty;
 	bool debug;
+	bool perf;
+	const char *wcet_dir; // where to save worst-case execution time cases
+	unsigned threads; // concurrent instances of scaling test
+	unsigned stress_cpu; // CPU stressor threads of deadline test
+	unsigned stress_mem; // memory stressor threads of deadline test
+	const char *fingerprint_dir; // where to store output fingerprints
+	const char *profile_dir; // where to store sampled call stacks
+	char **argv; // options only, to re-execute as helper
+	int argn;
+	helper_t helper; // when running as helper process
+	int helper_fd; // where the helper writes its results to
+	const LV2_Feature *const *features;
+	LV2_URID_Map *map;
+	LV2_URID_Unmap *unmap;
+	float sample_rate;
+	uint32_t block_length; // maximal
+	uint32_t sequence_size;
+	run_t *run; // shared runtime harness of current plugin
+	callback_stats_t callbacks [CALLBACK_MAX]; // host callbacks by phase
+	limit_t limits [LIMIT_MAX];
+	struct {
+		uint64_t dlopen; // ns
+		uint64_t instantiation; // ns
+		int64_t rss; // bytes
+		uint64_t allocations;
+		int64_t heap; // bytes
+	} stats;
+#ifdef ENABLE_ELF_TESTS
+	dep_t *deps; // cache of parsed shared libraries across plugins
+	unsigned n_deps;
+	char **dirs; // system library search directories
+	unsigned n_dirs;
+	symtab_t *symtab; // function symbols of current plugin binary
+#	ifdef ENABLE_CAPSTONE
+	isa_t *isa; // instruction sets of current plugin binary
+#	endif
+#endif
 #ifdef ENABLE_ONLINE_TESTS
 	bool online;
 	char *mail;
@@ -238,6 +561,9 @@ struct _app_t {
 		LilvNode *urid_unmap;
 
 		LilvNode *rsz_resize;
+		LilvNode *rsz_minimumSize;
+
+		LilvNode *midi_MidiEvent;
 
 		LilvNode *bufsz_boundedBlockLength;
 		LilvNode *bufsz_fixedBlockLength;
@@ -274,6 +600,9 @@ struct _test_t {
 bool
 test_plugin(app_t *app);
 
+bool
+helper_plugin(app_t *app);
+
 bool
 test_port(app_t *app);
 
@@ -293,14 +622,185 @@ test_url(app_t *app, const char *url);
 
 #ifdef ENABLE_ELF_TESTS
 bool
-test_visibility(const char *path, const char *description, char **symbols);
+test_visibility(const char *path, const char *description, char **symbols,
+	symtab_t *symtab);
 
 bool
 test_shared_libraries(const char *path, const char *const *whitelist,
 	unsigned n_whitelist, const char *const *blacklist, unsigned n_blacklist,
 	char **libraries);
+
+bool
+test_load_cost(const char *path, load_cost_t *cost);
+
+bool
+test_dependencies(app_t *app, const char *path, const char *const *blacklist,
+	unsigned n_blacklist, closure_t *closure);
+
+void
+free_dependencies(app_t *app);
+
+const char *
+lookup_symtab(const symtab_t *symtab, uint64_t addr);
+
+void
+free_symtab(symtab_t *symtab);
+
+#	ifdef ENABLE_CAPSTONE
+bool
+test_instruction_set(const char *path, isa_t *isa);
+
+bool
+test_realtime_calls(const uintptr_t *roots, unsigned n_roots,
+	const char *const *blacklist, unsigned n_blacklist, char **symbols);
+#	endif
 #endif
 
+run_t *
+lv2lint_run_new(app_t *app);
+
+void
+lv2lint_run_free(run_t *run);
+
+run_t *
+lv2lint_run_get(app_t *app);
+
+const ret_t *
+lv2lint_run_skipped(app_t *app);
+
+uint64_t
+lv2lint_run(run_t *run, uint32_t nsamples);
+
+run_port_t *
+lv2lint_run_port(run_t *run, run_port_type_t type, bool input,
+	const LilvNode *supports);
+
+bool
+lv2lint_run_overflow(const run_port_t *port);
+
+bool
+lv2lint_run_counters(run_t *run);
+
+void
+lv2lint_run_alias(run_t *run, run_port_t *input, run_port_t *output);
+
+void
+lv2lint_run_align(run_t *run, size_t alignment);
+
+void
+lv2lint_run_touch(run_t *run);
+
+uint32_t
+lv2lint_run_rand(uint32_t *state);
+
+float
+lv2lint_run_uniform(uint32_t *state);
+
+void
+lv2lint_run_signal(run_port_t *port, run_signal_t signal, uint32_t nsamples,
+	uint32_t *state);
+
+phase_t
+lv2lint_phase_set(phase_t phase);
+
+phase_t
+lv2lint_phase_get(void);
+
+unsigned
+lv2lint_thread(void);
+
+void
+lv2lint_callback(app_t *app, callback_t callback, const char *what);
+
+void
+lv2lint_callback_reset(app_t *app);
+
+const void *
+lv2lint_run_buffer(run_t *run, uint32_t index);
+
+void
+lv2lint_mem_reset(void);
+
+void
+lv2lint_mem_get(uint64_t *n_allocations, int64_t *peak_heap);
+
+int64_t
+lv2lint_mem_rss(void);
+
+void
+lv2lint_mem_refs_clear(void);
+
+int64_t
+lv2lint_mem_refs(void);
+
+bool
+lv2lint_log_init(bool echo, LV2_URID error, LV2_URID warning);
+
+void
+lv2lint_log_deinit(void);
+
+void
+lv2lint_log_reset(void);
+
+void
+lv2lint_log_pause(bool pause);
+
+int
+lv2lint_log_vprintf(LV2_URID type, const char *fmt, va_list args);
+
+log_msg_t *
+lv2lint_log_get(log_stats_t *log_stats);
+
+bool
+lv2lint_profile_start(void);
+
+void
+lv2lint_profile_stop(void);
+
+unsigned
+lv2lint_profile_write(FILE *f, const void *base, const void *symtab,
+	char **hottest, unsigned *n_hottest);
+
+static inline long
+lv2lint_cpus(void)
+{
+#if defined(_SC_NPROCESSORS_ONLN)
+	return sysconf(_SC_NPROCESSORS_ONLN);
+#else
+	return 1;
+#endif
+}
+
+static inline uint64_t
+lv2lint_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec*1000000000ULL + ts.tv_nsec;
+}
+
+lint_t
+lv2lint_limit(app_t *app, limit_id_t id, double val);
+
+#if defined(__linux__)
+pid_t
+lv2lint_helper_spawn(app_t *app, helper_t helper, int *fd);
+
+bool
+lv2lint_helper_read(int fd, void *buf, size_t size);
+
+bool
+lv2lint_helper_write(app_t *app, const void *buf, size_t size);
+
+bool
+lv2lint_helper_wait(pid_t pid, int *status);
+#endif
+
+const ret_t *
+lv2lint_grade(app_t *app, lint_t lnt, const ret_t *rets);
+
 int
 lv2lint_vprintf(app_t *app, const char *fmt, va_list args);
 
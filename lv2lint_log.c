@@ -0,0 +1,304 @@
+/*
+ * Copyright (c) 2016-2019 Hanspeter Portner (dev@open-music-kontrollers.ch)
+ *
+ * This is free software: you can redistribute it and/or modify
+ * it under the terms of the Artistic License 2.0 as published by
+ * The Perl Foundation.
+ *
+ * This source is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * Artistic License 2.0 for more details.
+ *
+ * You should have received a copy of the Artistic License 2.0
+ * along the source as a COPYING file. If not, obtain it from
+ * http://www.perlfoundation.org/artistic_license_2_0.
+ */
+
+#include <stdio.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include <lv2lint.h>
+
+#define LOG_SLOTS    1024 // power of 2
+#define LOG_KEEP     1024 // messages kept per plugin, further ones are counted only
+#define LOG_INTERVAL 10000000 // ns between drains
+
+typedef struct _slot_t slot_t;
+
+struct _slot_t {
+	atomic_size_t seq;
+	log_msg_t msg;
+};
+
+// bounded multi-producer queue, after Dmitry Vyukov
+static slot_t *slots = NULL;
+static atomic_size_t head = 0; // next to enqueue
+static size_t tail = 0; // next to dequeue, drainer only
+static atomic_uint dropped = 0;
+
+static pthread_t drainer;
+static atomic_bool draining = false;
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER; // of what follows
+static log_msg_t *msgs = NULL;
+static log_stats_t stats;
+static bool echo = false; // drained messages to stderr, too
+static LV2_URID log_error = 0;
+static LV2_URID log_warning = 0;
+
+int
+lv2lint_log_vprintf(LV2_URID type, const char *fmt, va_list args)
+{
+	if(!slots)
+	{
+		return 0;
+	}
+
+	size_t pos = atomic_load_explicit(&head, memory_order_relaxed);
+	slot_t *slot = NULL;
+
+	while(!slot)
+	{
+		slot_t *cand = &slots[pos & (LOG_SLOTS - 1)];
+		const size_t seq = atomic_load_explicit(&cand->seq, memory_order_acquire);
+		const intptr_t dif = (intptr_t)seq - (intptr_t)pos;
+
+		if(dif == 0)
+		{
+			if(atomic_compare_exchange_weak_explicit(&head, &pos, pos + 1,
+				memory_order_relaxed, memory_order_relaxed))
+			{
+				slot = cand;
+			}
+		}
+		else if(dif < 0)
+		{
+			// full, never block the calling thread
+			atomic_fetch_add_explicit(&dropped, 1, memory_order_relaxed);
+			return 0;
+		}
+		else
+		{
+			pos = atomic_load_explicit(&head, memory_order_relaxed);
+		}
+	}
+
+	log_msg_t *msg = &slot->msg;
+
+	msg->ns = lv2lint_now();
+	msg->thread = lv2lint_thread();
+	msg->phase = lv2lint_phase_get();
+	msg->type = type;
+
+	// truncates overlong messages
+	const int len = vsnprintf(msg->txt, sizeof(msg->txt), fmt, args);
+	if(len < 0)
+	{
+		msg->txt[0] = '\0';
+	}
+
+	// strip trailing newlines
+	size_t n = strlen(msg->txt);
+	while(n && (msg->txt[n - 1] == '\n') )
+	{
+		msg->txt[--n] = '\0';
+	}
+
+	atomic_store_explicit(&slot->seq, pos + 1, memory_order_release);
+
+	return len;
+}
+
+static void
+_drain(void)
+{
+	pthread_mutex_lock(&lock);
+
+	for( ; ; tail++)
+	{
+		slot_t *slot = &slots[tail & (LOG_SLOTS - 1)];
+		const size_t seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+
+		if(seq != tail + 1)
+		{
+			break; // empty
+		}
+
+		const log_msg_t *msg = &slot->msg;
+
+		if(echo)
+		{
+			fprintf(stderr, "%s\n", msg->txt);
+		}
+
+		if(msg->type && ( (msg->type == log_error) || (msg->type == log_warning) ) )
+		{
+			stats.n_severe++;
+		}
+
+		if(stats.n_kept < LOG_KEEP)
+		{
+			log_msg_t *tmp = realloc(msgs, (stats.n_kept + 1) * sizeof(log_msg_t));
+			if(tmp)
+			{
+				msgs = tmp;
+				msgs[stats.n_kept++] = *msg;
+			}
+		}
+
+		if(msg->phase == PHASE_RUN)
+		{
+			if(!stats.n_run)
+			{
+				stats.run_first = msg->ns;
+			}
+
+			stats.run_last = msg->ns;
+			stats.n_run++;
+		}
+
+		stats.n_msgs++;
+
+		atomic_store_explicit(&slot->seq, tail + LOG_SLOTS, memory_order_release);
+	}
+
+	stats.n_dropped += atomic_exchange_explicit(&dropped, 0, memory_order_relaxed);
+
+	pthread_mutex_unlock(&lock);
+}
+
+static void *
+_drainer(void *data __unused)
+{
+	const struct timespec interval = {
+		.tv_sec = 0,
+		.tv_nsec = LOG_INTERVAL
+	};
+
+	while(atomic_load_explicit(&draining, memory_order_acquire))
+	{
+		_drain();
+		nanosleep(&interval, NULL);
+	}
+
+	return NULL;
+}
+
+bool
+lv2lint_log_init(bool log_echo, LV2_URID error, LV2_URID warning)
+{
+	echo = log_echo;
+	log_error = error;
+	log_warning = warning;
+
+	slots = calloc(LOG_SLOTS, sizeof(slot_t));
+	if(!slots)
+	{
+		return false;
+	}
+
+	for(size_t i = 0; i < LOG_SLOTS; i++)
+	{
+		atomic_init(&slots[i].seq, i);
+	}
+
+	atomic_store_explicit(&draining, true, memory_order_release);
+
+	if(pthread_create(&drainer, NULL, _drainer, NULL))
+	{
+		atomic_store_explicit(&draining, false, memory_order_release);
+		free(slots);
+		slots = NULL;
+		return false;
+	}
+
+	return true;
+}
+
+void
+lv2lint_log_deinit(void)
+{
+	if(!slots)
+	{
+		return;
+	}
+
+	atomic_store_explicit(&draining, false, memory_order_release);
+	pthread_join(drainer, NULL);
+
+	lv2lint_log_reset();
+
+	free(slots);
+	slots = NULL;
+}
+
+void
+lv2lint_log_reset(void)
+{
+	if(!slots)
+	{
+		return;
+	}
+
+	_drain();
+
+	pthread_mutex_lock(&lock);
+	free(msgs);
+	msgs = NULL;
+	memset(&stats, 0x0, sizeof(stats));
+	pthread_mutex_unlock(&lock);
+}
+
+// holds the drainer off its realloc and fprintf while something is measured,
+// messages queue up meanwhile, or are counted as dropped once the queue is full
+void
+lv2lint_log_pause(bool pause)
+{
+	if(!slots)
+	{
+		return;
+	}
+
+	if(pause)
+	{
+		pthread_mutex_lock(&lock); // waits for a drain in progress
+	}
+	else
+	{
+		pthread_mutex_unlock(&lock);
+	}
+}
+
+log_msg_t *
+lv2lint_log_get(log_stats_t *log_stats)
+{
+	log_msg_t *log_msgs = NULL;
+
+	memset(log_stats, 0x0, sizeof(log_stats_t));
+
+	if(!slots)
+	{
+		return NULL;
+	}
+
+	_drain();
+
+	pthread_mutex_lock(&lock);
+	if(stats.n_kept)
+	{
+		log_msgs = malloc(stats.n_kept * sizeof(log_msg_t));
+		if(log_msgs)
+		{
+			memcpy(log_msgs, msgs, stats.n_kept * sizeof(log_msg_t));
+			*log_stats = stats;
+		}
+	}
+	else
+	{
+		*log_stats = stats;
+	}
+	pthread_mutex_unlock(&lock);
+
+	return log_msgs;
+}
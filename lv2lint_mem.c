@@ -0,0 +1,267 @@
+/*
+ * Copyright (c) 2016-2019 Hanspeter Portner (dev@open-music-kontrollers.ch)
+ *
+ * This is free software: you can redistribute it and/or modify
+ * it under the terms of the Artistic License 2.0 as published by
+ * The Perl Foundation.
+ *
+ * This source is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * Artistic License 2.0 for more details.
+ *
+ * You should have received a copy of the Artistic License 2.0
+ * along the source as a COPYING file. If not, obtain it from
+ * http://www.perlfoundation.org/artistic_license_2_0.
+ */
+
+#include <stdio.h>
+#include <errno.h>
+#include <stdatomic.h>
+
+#include <lv2lint.h>
+
+#if defined(__GLIBC__)
+#	include <malloc.h>
+
+// the glibc allocator proper, we interpose the public symbols below
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t nmemb, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+extern void *__libc_memalign(size_t alignment, size_t size);
+extern void *__libc_valloc(size_t size);
+extern void *__libc_pvalloc(size_t size);
+extern void __libc_free(void *ptr);
+
+static atomic_uint_fast64_t allocations = 0;
+static atomic_int_fast64_t current = 0;
+static atomic_int_fast64_t peak = 0;
+
+static inline void
+_account(void *ptr)
+{
+	if(!ptr)
+	{
+		return;
+	}
+
+	const int_fast64_t sz = malloc_usable_size(ptr);
+	const int_fast64_t cur = atomic_fetch_add_explicit(&current, sz,
+		memory_order_relaxed) + sz;
+	int_fast64_t old = atomic_load_explicit(&peak, memory_order_relaxed);
+
+	while( (cur > old) && !atomic_compare_exchange_weak_explicit(&peak, &old, cur,
+		memory_order_relaxed, memory_order_relaxed) )
+	{
+		// try again
+	}
+
+	atomic_fetch_add_explicit(&allocations, 1, memory_order_relaxed);
+}
+
+static inline void
+_unaccount(void *ptr)
+{
+	if(!ptr)
+	{
+		return;
+	}
+
+	const int_fast64_t sz = malloc_usable_size(ptr);
+	atomic_fetch_sub_explicit(&current, sz, memory_order_relaxed);
+}
+
+void *
+malloc(size_t size)
+{
+	void *ptr = __libc_malloc(size);
+	_account(ptr);
+
+	return ptr;
+}
+
+void *
+calloc(size_t nmemb, size_t size)
+{
+	void *ptr = __libc_calloc(nmemb, size);
+	_account(ptr);
+
+	return ptr;
+}
+
+void *
+realloc(void *ptr, size_t size)
+{
+	const int_fast64_t sz = ptr ? (int_fast64_t)malloc_usable_size(ptr) : 0;
+	void *nptr = __libc_realloc(ptr, size);
+
+	if(nptr || !size) // old pointer has been released
+	{
+		atomic_fetch_sub_explicit(&current, sz, memory_order_relaxed);
+	}
+	_account(nptr);
+
+	return nptr;
+}
+
+void *
+memalign(size_t alignment, size_t size)
+{
+	void *ptr = __libc_memalign(alignment, size);
+	_account(ptr);
+
+	return ptr;
+}
+
+void *
+aligned_alloc(size_t alignment, size_t size)
+{
+	return memalign(alignment, size);
+}
+
+void *
+valloc(size_t size)
+{
+	void *ptr = __libc_valloc(size);
+	_account(ptr);
+
+	return ptr;
+}
+
+void *
+pvalloc(size_t size)
+{
+	void *ptr = __libc_pvalloc(size);
+	_account(ptr);
+
+	return ptr;
+}
+
+int
+posix_memalign(void **memptr, size_t alignment, size_t size)
+{
+	// alignment must be a power of two multiple of sizeof(void *)
+	if( (alignment % sizeof(void *)) || (alignment & (alignment - 1)) || !alignment)
+	{
+		return EINVAL;
+	}
+
+	void *ptr = memalign(alignment, size);
+	if(!ptr && size)
+	{
+		return ENOMEM;
+	}
+
+	*memptr = ptr;
+	return 0;
+}
+
+void
+free(void *ptr)
+{
+	_unaccount(ptr);
+	__libc_free(ptr);
+}
+
+void
+lv2lint_mem_reset(void)
+{
+	atomic_store_explicit(&allocations, 0, memory_order_relaxed);
+	atomic_store_explicit(&current, 0, memory_order_relaxed);
+	atomic_store_explicit(&peak, 0, memory_order_relaxed);
+}
+
+void
+lv2lint_mem_get(uint64_t *n_allocations, int64_t *peak_heap)
+{
+	*n_allocations = atomic_load_explicit(&allocations, memory_order_relaxed);
+	*peak_heap = atomic_load_explicit(&peak, memory_order_relaxed);
+}
+#else
+void
+lv2lint_mem_reset(void)
+{
+	// not supported
+}
+
+void
+lv2lint_mem_get(uint64_t *n_allocations, int64_t *peak_heap)
+{
+	*n_allocations = 0;
+	*peak_heap = 0;
+}
+#endif
+
+int64_t
+lv2lint_mem_rss(void)
+{
+	int64_t rss = 0;
+
+#if defined(__linux__)
+	FILE *f = fopen("/proc/self/statm", "r");
+	if(f)
+	{
+		long size;
+		long resident;
+
+		if(fscanf(f, "%ld %ld", &size, &resident) == 2)
+		{
+			rss = (int64_t)resident * sysconf(_SC_PAGESIZE);
+		}
+
+		fclose(f);
+	}
+#endif
+
+	return rss;
+}
+
+void
+lv2lint_mem_refs_clear(void)
+{
+#if defined(__linux__)
+	// clear referenced bits of all pages of this process
+	FILE *f = fopen("/proc/self/clear_refs", "w");
+	if(f)
+	{
+		fputs("1", f);
+		fclose(f);
+	}
+#endif
+}
+
+int64_t
+lv2lint_mem_refs(void)
+{
+	int64_t refs = 0;
+
+#if defined(__linux__)
+	FILE *f = fopen("/proc/self/smaps", "r");
+	if(f)
+	{
+		char line [512];
+		bool code = false;
+
+		while(fgets(line, sizeof(line), f))
+		{
+			unsigned long from;
+			unsigned long to;
+			char perms [8];
+			long kib;
+
+			if(sscanf(line, "%lx-%lx %7s", &from, &to, perms) == 3)
+			{
+				code = strchr(perms, 'x') != NULL; // new mapping
+			}
+			else if(!code && (sscanf(line, "Referenced: %ld kB", &kib) == 1) )
+			{
+				refs += (int64_t)kib * 1024;
+			}
+		}
+
+		fclose(f);
+	}
+#endif
+
+	return refs;
+}
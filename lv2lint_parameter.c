@@ -18,6 +18,8 @@
 #include <lv2lint.h>
 
 #include <lv2/lv2plug.in/ns/ext/atom/atom.h>
+#include <lv2/lv2plug.in/ns/ext/atom/util.h>
+#include <lv2/lv2plug.in/ns/ext/patch/patch.h>
 #include <lv2/lv2plug.in/ns/extensions/units/units.h>
 
 static const ret_t *
@@ -379,11 +381,325 @@ _test_unit(app_t *app)
 	return ret;
 }
 
+#define PATCH_TIMEOUT 64 // blocks
+#define PATCH_BURSTS  32
+
+static bool
+_patch_value(app_t *app, run_t *run, LV2_Atom_Forge *forge, uint8_t *buf,
+	size_t size)
+{
+	LilvNode *range = lilv_world_get(app->world, app->parameter,
+		app->uris.rdfs_range, NULL);
+	if(!range)
+	{
+		return false;
+	}
+
+	LV2_Atom_Forge_Ref ref = 0;
+
+	lv2_atom_forge_set_buffer(forge, buf, size);
+
+	// forge a value within the range parsed by _test_range
+	if(lilv_node_equals(range, app->uris.atom_Int))
+	{
+		ref = lv2_atom_forge_int(forge, app->max.i64);
+	}
+	else if(lilv_node_equals(range, app->uris.atom_Long))
+	{
+		ref = lv2_atom_forge_long(forge, app->max.i64);
+	}
+	else if(lilv_node_equals(range, app->uris.atom_Float))
+	{
+		ref = lv2_atom_forge_float(forge, app->max.f64);
+	}
+	else if(lilv_node_equals(range, app->uris.atom_Double))
+	{
+		ref = lv2_atom_forge_double(forge, app->max.f64);
+	}
+	else if(lilv_node_equals(range, app->uris.atom_Bool))
+	{
+		ref = lv2_atom_forge_bool(forge, true);
+	}
+	else if(lilv_node_equals(range, app->uris.atom_String))
+	{
+		ref = lv2_atom_forge_string(forge, "lv2lint", 7);
+	}
+	else if(lilv_node_equals(range, app->uris.atom_URID))
+	{
+		ref = lv2_atom_forge_urid(forge, run->urid.patch_value);
+	}
+
+	lilv_node_free(range);
+
+	return ref != 0;
+}
+
+static bool
+_patch_set(run_t *run, run_port_t *port, LV2_URID property,
+	const LV2_Atom *value)
+{
+	LV2_Atom_Forge *forge = &port->forge;
+	LV2_Atom_Forge_Frame frame;
+
+	if(  !lv2_atom_forge_frame_time(forge, 0)
+		|| !lv2_atom_forge_object(forge, &frame, 0, run->urid.patch_Set)
+		|| !lv2_atom_forge_key(forge, run->urid.patch_property)
+		|| !lv2_atom_forge_urid(forge, property)
+		|| !lv2_atom_forge_key(forge, run->urid.patch_value)
+		|| !lv2_atom_forge_write(forge, value, sizeof(LV2_Atom) + value->size) )
+	{
+		return false;
+	}
+
+	lv2_atom_forge_pop(forge, &frame);
+
+	return true;
+}
+
+static bool
+_patch_get(run_t *run, run_port_t *port, LV2_URID property)
+{
+	LV2_Atom_Forge *forge = &port->forge;
+	LV2_Atom_Forge_Frame frame;
+
+	if(  !lv2_atom_forge_frame_time(forge, 0)
+		|| !lv2_atom_forge_object(forge, &frame, 0, run->urid.patch_Get)
+		|| !lv2_atom_forge_key(forge, run->urid.patch_property)
+		|| !lv2_atom_forge_urid(forge, property) )
+	{
+		return false;
+	}
+
+	lv2_atom_forge_pop(forge, &frame);
+
+	return true;
+}
+
+static bool
+_is_object(run_t *run, const LV2_Atom *atom)
+{
+	return (atom->type == run->urid.atom_Object)
+		|| (atom->type == run->urid.atom_Blank);
+}
+
+static const LV2_Atom *
+_patch_response(run_t *run, LV2_URID property)
+{
+	for(unsigned i = 0; i < run->n_ports; i++)
+	{
+		const run_port_t *port = &run->ports[i];
+		const LV2_Atom_Sequence *seq = port->buf;
+
+		if( (port->type != RUN_PORT_ATOM) || port->input
+			|| (seq->atom.type != run->urid.atom_Sequence) )
+		{
+			continue;
+		}
+
+		LV2_ATOM_SEQUENCE_FOREACH(seq, ev)
+		{
+			const LV2_Atom_Object *obj = (const LV2_Atom_Object *)&ev->body;
+
+			if(!_is_object(run, &obj->atom))
+			{
+				continue;
+			}
+
+			if(obj->body.otype == run->urid.patch_Set)
+			{
+				const LV2_Atom_URID *prop = NULL;
+				const LV2_Atom *value = NULL;
+
+				lv2_atom_object_get(obj,
+					run->urid.patch_property, &prop,
+					run->urid.patch_value, &value,
+					0);
+
+				if(prop && (prop->atom.type == run->urid.atom_URID)
+					&& (prop->body == property) && value)
+				{
+					return value;
+				}
+			}
+			else if(obj->body.otype == run->urid.patch_Put)
+			{
+				const LV2_Atom_Object *body = NULL;
+				const LV2_Atom *value = NULL;
+
+				lv2_atom_object_get(obj, run->urid.patch_body, &body, 0);
+
+				if(body && _is_object(run, &body->atom))
+				{
+					lv2_atom_object_get(body, property, &value, 0);
+
+					if(value)
+					{
+						return value;
+					}
+				}
+			}
+		}
+	}
+
+	return NULL;
+}
+
+static const ret_t *
+_test_round_trip(app_t *app)
+{
+	static const ret_t ret_no_response = {
+		.lnt = LINT_WARN,
+		.msg = "no response to patch:Get within %s",
+		.uri = LV2_PATCH__Get,
+		.dsc = "Hosts and UIs query the current value of parameters with "
+			"patch:Get, the plugin should answer with a patch:Set or patch:Put."
+	},
+	ret_not_applied = {
+		.lnt = LINT_WARN,
+		.msg = "patch:Set not applied, patch:Get answers with a different value",
+		.uri = LV2_PATCH__Set,
+		.dsc = NULL
+	},
+	ret_round_trip [] = {
+		{
+			.lnt = LINT_NOTE,
+			.msg = "patch round-trip: %s",
+			.uri = LV2_PATCH__Set,
+			.dsc = "Blocks and time needed until a patch:Set is applied and answered "
+				"on a patch:Get, and run() cost per patch:Set at high message rates."
+		},
+		{
+			.lnt = LINT_WARN,
+			.msg = "patch round-trip exceeds limit: %s",
+			.uri = LV2_PATCH__Set,
+			.dsc = "Automation-heavy sessions push thousands of patch messages per "
+				"second. Handle patch messages directly in run() and keep their "
+				"processing cheap."
+		}
+	};
+
+	const ret_t *ret = NULL;
+
+	if(!app->perf || !app->writables
+		|| !lilv_nodes_contains(app->writables, app->parameter))
+	{
+		return NULL;
+	}
+
+	run_t *run = lv2lint_run_get(app);
+	if(!run)
+	{
+		return lv2lint_run_skipped(app);
+	}
+
+	run_port_t *control = lv2lint_run_port(run, RUN_PORT_ATOM, true,
+		app->uris.patch_Message);
+	if(!control)
+	{
+		return NULL;
+	}
+
+	const LV2_URID property = app->map->map(app->map->handle,
+		lilv_node_as_uri(app->parameter));
+
+	LV2_Atom_Forge forge;
+	uint8_t buf [64];
+	lv2_atom_forge_init(&forge, app->map);
+	if(!_patch_value(app, run, &forge, buf, sizeof(buf)))
+	{
+		return NULL; // no value to forge for this range
+	}
+	const LV2_Atom *value = (const LV2_Atom *)buf;
+
+	// let the plugin settle
+	lv2lint_run(run, run->block_length);
+	lv2lint_run(run, run->block_length);
+
+	// set and query in the same cycle
+	const LV2_Atom *response = NULL;
+	unsigned blocks = 0;
+	uint64_t ns = 0;
+
+	if(_patch_set(run, control, property, value) && _patch_get(run, control, property))
+	{
+		while(!response && (blocks++ < PATCH_TIMEOUT) )
+		{
+			const uint64_t t0 = lv2lint_now();
+			lv2lint_run(run, run->block_length);
+			ns += lv2lint_now() - t0;
+
+			response = _patch_response(run, property);
+		}
+	}
+
+	if(!response)
+	{
+		if(asprintf(app->urn, "%u blocks", PATCH_TIMEOUT) == -1)
+		{
+			*app->urn = NULL;
+		}
+
+		ret = &ret_no_response;
+	}
+	else if( (response->type != value->type) || (response->size != value->size)
+		|| memcmp(response + 1, value + 1, value->size) )
+	{
+		ret = &ret_not_applied;
+	}
+	else
+	{
+		uint64_t ns_idle = 0;
+		uint64_t ns_burst = 0;
+		uint32_t n_msgs = 0;
+
+		// fill whole sequences with patch:Set messages
+		for(unsigned i = 0; i < PATCH_BURSTS; i++)
+		{
+			ns_idle += lv2lint_run(run, run->block_length);
+
+			const uint32_t offset = control->forge.offset;
+			if(!_patch_set(run, control, property, value))
+			{
+				break;
+			}
+			n_msgs++;
+
+			const uint32_t msg_size = control->forge.offset - offset;
+			while(control->forge.offset + msg_size <= control->forge.size)
+			{
+				_patch_set(run, control, property, value);
+				n_msgs++;
+			}
+
+			ns_burst += lv2lint_run(run, run->block_length);
+		}
+
+		const double round_trip_us = ns * 1e-3;
+		const double cost_us = (n_msgs && (ns_burst > ns_idle))
+			? (ns_burst - ns_idle) * 1e-3 / n_msgs
+			: 0.0;
+
+		lint_t lnt = lv2lint_limit(app, LIMIT_PATCH_LATENCY, blocks);
+		lnt |= lv2lint_limit(app, LIMIT_PATCH_COST, cost_us);
+
+		if(asprintf(app->urn, "%u block(s), %.1f us, %.2f us per message",
+			blocks, round_trip_us, cost_us) == -1)
+		{
+			*app->urn = NULL;
+		}
+
+		ret = lv2lint_grade(app, lnt, ret_round_trip);
+	}
+
+	return ret;
+}
+
 static const test_t tests [] = {
-	{"Label",   _test_label},
-	{"Comment", _test_comment},
-	{"Range",   _test_range},
-	{"Unit",    _test_unit},
+	{"Label",      _test_label},
+	{"Comment",    _test_comment},
+	{"Range",      _test_range},
+	{"Unit",       _test_unit},
+	{"Round Trip", _test_round_trip},
 	//TODO scalePoint
 };
 
@@ -398,15 +714,25 @@ test_parameter(app_t *app)
 	if(!rets)
 		return flag;
 
+	// forget range of previous parameter
+	memset(&app->min, 0x0, sizeof(var_t));
+	memset(&app->max, 0x0, sizeof(var_t));
+
 	for(unsigned i=0; i<tests_n; i++)
 	{
 		const test_t *test = &tests[i];
 		res_t *res = &rets[i];
 
 		res->urn = NULL;
+		res->lnt = 0;
 		app->urn = &res->urn;
+		app->lnt = &res->lnt;
 		res->ret = test->cb(app);
-		if(res->ret && (res->ret->lnt & app->show) )
+		if(!res->ret)
+			res->lnt = 0;
+		else if(!res->lnt) // not graded by the test
+			res->lnt = res->ret->lnt;
+		if(res->lnt & app->show)
 			msg = true;
 	}
 
@@ -15,9 +15,33 @@
  * http://www.perlfoundation.org/artistic_license_2_0.
  */
 
+#include <stdio.h>
+#include <inttypes.h>
+#include <errno.h>
+#include <ctype.h>
+#include <math.h>
+#include <sched.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <signal.h>
+
+#if defined(__linux__)
+#	include <sys/wait.h>
+#endif
+#if !defined(_WIN32)
+#	include <glob.h>
+#endif
+#if defined(__GLIBC__)
+#	include <dlfcn.h>
+#endif
+
 #include <lv2lint.h>
 
 #include <lv2/lv2plug.in/ns/ext/patch/patch.h>
+#include <lv2/lv2plug.in/ns/ext/atom/util.h>
+#include <lv2/lv2plug.in/ns/ext/midi/midi.h>
+#include <lv2/lv2plug.in/ns/ext/log/log.h>
+#include <lv2/lv2plug.in/ns/ext/urid/urid.h>
 #include <lv2/lv2plug.in/ns/ext/worker/worker.h>
 #include <lv2/lv2plug.in/ns/ext/uri-map/uri-map.h>
 #include <lv2/lv2plug.in/ns/ext/state/state.h>
@@ -45,115 +69,3912 @@ _test_instantiation(app_t *app)
 	return ret;
 }
 
-#ifdef ENABLE_ELF_TESTS
 static const ret_t *
-_test_symbols(app_t *app)
+_test_load_time(app_t *app)
+{
+	static const ret_t ret_load_time [] = {
+		{
+			.lnt = LINT_NOTE,
+			.msg = "load time: %s",
+			.uri = LV2_CORE__binary,
+			.dsc = "Time needed to dlopen the plugin binary and to instantiate the plugin."
+		},
+		{
+			.lnt = LINT_WARN,
+			.msg = "load time exceeds limit: %s",
+			.uri = LV2_CORE__binary,
+			.dsc = "Hosts loading sessions with hundreds of plugin instances are slowed "
+				"down considerably. Defer expensive initialization to the worker or "
+				"share immutable tables between instances."
+		}
+	};
+
+	const ret_t *ret = NULL;
+
+	if(app->perf && app->instance)
+	{
+		const double dlopen_ms = app->stats.dlopen * 1e-6;
+		const double instantiation_ms = app->stats.instantiation * 1e-6;
+
+		lint_t lnt = lv2lint_limit(app, LIMIT_DLOPEN, dlopen_ms);
+		lnt |= lv2lint_limit(app, LIMIT_INSTANTIATION, instantiation_ms);
+
+		if(asprintf(app->urn, "dlopen %.3f ms, instantiation %.3f ms",
+			dlopen_ms, instantiation_ms) == -1)
+		{
+			*app->urn = NULL;
+		}
+
+		ret = lv2lint_grade(app, lnt, ret_load_time);
+	}
+
+	return ret;
+}
+
+static const ret_t *
+_test_footprint(app_t *app)
+{
+	static const ret_t ret_footprint [] = {
+		{
+			.lnt = LINT_NOTE,
+			.msg = "memory footprint: %s",
+			.uri = LV2_CORE__binary,
+			.dsc = "Memory needed to load and instantiate the plugin."
+		},
+		{
+			.lnt = LINT_WARN,
+			.msg = "memory footprint exceeds limit: %s",
+			.uri = LV2_CORE__binary,
+			.dsc = "Large per-instance memory footprints add up quickly in sessions "
+				"with many instances. Share immutable tables between instances and "
+				"avoid many small allocations."
+		}
+	};
+
+	const ret_t *ret = NULL;
+
+	if(app->perf && app->instance)
+	{
+		const double rss_kib = app->stats.rss / 1024.0;
+		const double heap_kib = app->stats.heap / 1024.0;
+
+		lint_t lnt = lv2lint_limit(app, LIMIT_RSS, rss_kib);
+		lnt |= lv2lint_limit(app, LIMIT_HEAP, heap_kib);
+		lnt |= lv2lint_limit(app, LIMIT_ALLOCATIONS, app->stats.allocations);
+
+		if(asprintf(app->urn, "RSS %+.0f KiB, heap peak %.0f KiB, %"PRIu64" allocations",
+			rss_kib, heap_kib, app->stats.allocations) == -1)
+		{
+			*app->urn = NULL;
+		}
+
+		ret = lv2lint_grade(app, lnt, ret_footprint);
+	}
+
+	return ret;
+}
+
+#define FIRST_RUN_BLOCKS 64
+#define FIRST_RUN_WARMUP 4
+
+static const ret_t *
+_test_first_run(app_t *app)
+{
+	static const ret_t ret_first_run [] = {
+		{
+			.lnt = LINT_NOTE,
+			.msg = "first run() call: %s",
+			.uri = LV2_CORE__hardRTCapable,
+			.dsc = "Cost of the very first run() call after activation compared to "
+				"steady state."
+		},
+		{
+			.lnt = LINT_WARN,
+			.msg = "first run() call exceeds limit: %s",
+			.uri = LV2_CORE__hardRTCapable,
+			.dsc = "The first run() call after insertion glitches. Touch (e.g. "
+				"memset) all buffers and tables in instantiate() or activate(), "
+				"link with -Wl,-z,now to bind symbols at load time and do not "
+				"defer initialization to the first call of run()."
+		}
+	};
+
+	const ret_t *ret = NULL;
+
+	if(!app->perf)
+	{
+		return NULL;
+	}
+
+	// a fresh instance, whatever other tests did to the shared one before
+	run_t *run = lv2lint_run_new(app);
+	if(!run)
+	{
+		return NULL;
+	}
+
+	// records the cold cost
+	lv2lint_run(run, run->block_length);
+
+	uint64_t ns = 0;
+	long minflt = 0;
+	long majflt = 0;
+
+	for(unsigned b = 0; b < FIRST_RUN_WARMUP + FIRST_RUN_BLOCKS; b++)
+	{
+#if !defined(_WIN32)
+		struct rusage ru0;
+		struct rusage ru1;
+
+		getrusage(RUN_RUSAGE, &ru0);
+		lv2lint_run(run, run->block_length);
+		getrusage(RUN_RUSAGE, &ru1);
+
+		if(b >= FIRST_RUN_WARMUP)
+		{
+			minflt += ru1.ru_minflt - ru0.ru_minflt;
+			majflt += ru1.ru_majflt - ru0.ru_majflt;
+		}
+#else
+		lv2lint_run(run, run->block_length); // page faults are not counted
+#endif
+
+		if(b >= FIRST_RUN_WARMUP)
+		{
+			ns += run->ns;
+		}
+	}
+
+	const double steady_us = ns * 1e-3 / FIRST_RUN_BLOCKS;
+	const double first_us = run->first.ns * 1e-3;
+	const double ratio = (steady_us > 0.0)
+		? first_us / steady_us
+		: 0.0;
+
+	lint_t lnt = lv2lint_limit(app, LIMIT_FIRST_RUN, ratio);
+	if(run->first.majflt > 0)
+	{
+		lnt |= LINT_WARN; // needed disk I/O on the audio thread
+	}
+
+	if(asprintf(app->urn, "%.1f us (%.1fx steady state), %ld minor/%ld major "
+		"page faults (%.1f/%.1f per block in steady state)",
+		first_us, ratio, run->first.minflt, run->first.majflt,
+		(double)minflt / FIRST_RUN_BLOCKS, (double)majflt / FIRST_RUN_BLOCKS) == -1)
+	{
+		*app->urn = NULL;
+	}
+
+	lv2lint_run_free(run);
+
+	ret = lv2lint_grade(app, lnt, ret_first_run);
+
+	return ret;
+}
+
+#define SEQUENCE_BLOCKS 64
+
+static uint32_t
+_sequence_fill(run_t *run, run_port_t *port, unsigned pattern)
+{
+	LV2_Atom_Forge *forge = &port->forge;
+	const uint32_t ev_size = sizeof(LV2_Atom_Event) + lv2_atom_pad_size(3);
+	const uint32_t n_events = (forge->size - forge->offset) / ev_size;
+	uint32_t n;
+
+	for(n = 0; n < n_events; n++)
+	{
+		const uint8_t chan = n & 0xf;
+		const uint8_t note = (n >> 4) & 0x7f;
+		uint8_t msg [3];
+
+		switch(pattern % 4)
+		{
+			case 0: // note storm, voices pile up
+				msg[0] = LV2_MIDI_MSG_NOTE_ON | chan;
+				msg[1] = note;
+				msg[2] = 0x7f;
+				break;
+			case 1: // controller flood, skipping channel mode messages
+				msg[0] = LV2_MIDI_MSG_CONTROLLER | chan;
+				msg[1] = note % 0x78;
+				msg[2] = n & 0x7f;
+				break;
+			case 2: // pitch bend flood
+				msg[0] = LV2_MIDI_MSG_BENDER | chan;
+				msg[1] = n & 0x7f;
+				msg[2] = note;
+				break;
+			default: // release all voices again
+				msg[0] = LV2_MIDI_MSG_NOTE_OFF | chan;
+				msg[1] = note;
+				msg[2] = 0x0;
+				break;
+		}
+
+		// spread events evenly over the whole block
+		const int64_t frames = (int64_t)n * run->block_length / n_events;
+
+		if(  !lv2_atom_forge_frame_time(forge, frames)
+			|| !lv2_atom_forge_atom(forge, sizeof(msg), run->urid.midi_MidiEvent)
+			|| !lv2_atom_forge_write(forge, msg, sizeof(msg)) )
+		{
+			break;
+		}
+	}
+
+	return n;
+}
+
+static bool
+_sequence_valid(run_t *run, const run_port_t *port)
+{
+	const LV2_Atom_Sequence *seq = port->buf;
+	const uint32_t capacity = port->size - sizeof(LV2_Atom);
+
+	// the host announced an atom:Chunk, the plugin must overwrite it
+	if(  (seq->atom.type != run->urid.atom_Sequence)
+		|| (seq->atom.size < sizeof(LV2_Atom_Sequence_Body))
+		|| (seq->atom.size > capacity) )
+	{
+		return false;
+	}
+
+	const uint8_t *end = (const uint8_t *)&seq->body + seq->atom.size;
+
+	LV2_ATOM_SEQUENCE_FOREACH(seq, ev)
+	{
+		const uint8_t *body = (const uint8_t *)&ev->body + sizeof(LV2_Atom);
+
+		if( (body > end) || (body + ev->body.size > end) )
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static const ret_t *
+_test_sequence(app_t *app)
+{
+	static const ret_t ret_overflow = {
+		.lnt = LINT_FAIL,
+		.msg = "output sequence overflows its capacity: %s",
+		.uri = LV2_ATOM__Sequence,
+		.dsc = "Plugins must never write beyond the capacity the host announces "
+			"in the atom:Chunk of output ports. Check the return values of the "
+			"atom forge and drop events when the sequence is full."
+	},
+	ret_invalid = {
+		.lnt = LINT_WARN,
+		.msg = "output sequence size not set correctly: %s",
+		.uri = LV2_ATOM__Sequence,
+		.dsc = "Plugins must write a valid atom:Sequence to output ports in every "
+			"cycle, even when it is empty. Its size must cover all events and "
+			"must not exceed the announced capacity."
+	},
+	ret_sequence [] = {
+		{
+			.lnt = LINT_NOTE,
+			.msg = "dense sequences: %s",
+			.uri = LV2_MIDI__MidiEvent,
+			.dsc = "run() cost per event of note storms, controller and pitch bend "
+				"floods filling whole input sequences."
+		},
+		{
+			.lnt = LINT_WARN,
+			.msg = "dense sequences exceed limit: %s",
+			.uri = LV2_MIDI__MidiEvent,
+			.dsc = "Large MIDI bursts are a common source of xruns. Keep per-event "
+				"processing cheap and defer expensive work like coefficient "
+				"updates to once per block."
+		}
+	};
+
+	const ret_t *ret = NULL;
+
+	if(!app->perf)
+	{
+		return NULL;
+	}
+
+	run_t *run = lv2lint_run_get(app);
+	if(!run)
+	{
+		return lv2lint_run_skipped(app);
+	}
+
+	bool has_midi = false;
+	bool has_output = false;
+
+	for(unsigned i = 0; i < run->n_ports; i++)
+	{
+		const run_port_t *port = &run->ports[i];
+
+		if(port->type != RUN_PORT_ATOM)
+		{
+			continue;
+		}
+
+		if(!port->input)
+		{
+			has_output = true;
+		}
+		else if(lilv_port_supports_event(app->plugin, port->port, app->uris.midi_MidiEvent))
+		{
+			has_midi = true;
+		}
+	}
+
+	if(!has_midi && !has_output)
+	{
+		return NULL;
+	}
+
+	const run_port_t *overflow = NULL;
+	const run_port_t *invalid = NULL;
+	uint64_t ns_idle = 0;
+	uint64_t ns_dense = 0;
+	uint64_t n_events = 0;
+
+	for(unsigned b = 0; (b < SEQUENCE_BLOCKS) && !overflow; b++)
+	{
+		// alternate empty and dense blocks to isolate the per-event cost
+		const bool dense = b & 1;
+
+		for(unsigned i = 0; dense && (i < run->n_ports); i++)
+		{
+			run_port_t *port = &run->ports[i];
+
+			if( (port->type == RUN_PORT_ATOM) && port->input
+				&& lilv_port_supports_event(app->plugin, port->port, app->uris.midi_MidiEvent) )
+			{
+				n_events += _sequence_fill(run, port, b >> 1);
+			}
+		}
+
+		const uint64_t ns = lv2lint_run(run, run->block_length);
+
+		if(dense)
+		{
+			ns_dense += ns;
+		}
+		else
+		{
+			ns_idle += ns;
+		}
+
+		for(unsigned i = 0; i < run->n_ports; i++)
+		{
+			const run_port_t *port = &run->ports[i];
+
+			if( (port->type != RUN_PORT_ATOM) || port->input)
+			{
+				continue;
+			}
+
+			if(lv2lint_run_overflow(port) || (run->fault == (int)i) )
+			{
+				overflow = port;
+			}
+			else if(!invalid && !_sequence_valid(run, port))
+			{
+				invalid = port;
+			}
+		}
+	}
+
+	if(overflow || invalid)
+	{
+		const run_port_t *port = overflow ? overflow : invalid;
+		const LilvNode *symbol = lilv_port_get_symbol(app->plugin, port->port);
+
+		*app->urn = strdup(lilv_node_as_string(symbol));
+		ret = overflow ? &ret_overflow : &ret_invalid;
+	}
+	else if(n_events)
+	{
+		const double cost_us = (ns_dense > ns_idle)
+			? (ns_dense - ns_idle) * 1e-3 / n_events
+			: 0.0;
+
+		const lint_t lnt = lv2lint_limit(app, LIMIT_EVENT_COST, cost_us);
+
+		if(asprintf(app->urn, "%"PRIu64" events in %u blocks, %.3f us per event",
+			n_events, SEQUENCE_BLOCKS / 2, cost_us) == -1)
+		{
+			*app->urn = NULL;
+		}
+
+		ret = lv2lint_grade(app, lnt, ret_sequence);
+	}
+
+	return ret;
+}
+
+#define WCET_RANDOM 32 // random candidates
+#define WCET_CLIMB  64 // hill-climbing mutations of the best candidate
+#define WCET_TRIALS 3 // blocks per candidate, the most expensive one counts
+
+typedef enum _wcet_midi_t {
+	WCET_MIDI_NONE,
+	WCET_MIDI_NOTES,
+	WCET_MIDI_CONTROLLERS,
+	WCET_MIDI_BENDS,
+
+	WCET_MIDI_MAX
+} wcet_midi_t;
+
+static const char *wcet_signals [RUN_SIGNAL_MAX] = {
+	[RUN_SIGNAL_SILENCE]    = "silence",
+	[RUN_SIGNAL_NOISE]      = "noise",
+	[RUN_SIGNAL_FULL_SCALE] = "full-scale",
+	[RUN_SIGNAL_DENORMAL]   = "denormal"
+};
+
+static const char *wcet_midis [WCET_MIDI_MAX] = {
+	[WCET_MIDI_NONE]         = "none",
+	[WCET_MIDI_NOTES]        = "notes",
+	[WCET_MIDI_CONTROLLERS]  = "controllers",
+	[WCET_MIDI_BENDS]        = "bends"
+};
+
+typedef struct _wcet_case_t wcet_case_t;
+
+struct _wcet_case_t {
+	run_signal_t signal;
+	wcet_midi_t midi;
+	uint64_t ns;
+	float controls []; // one per port, only control inputs are used
+};
+
+static bool
+_wcet_control(const run_port_t *port)
+{
+	return (port->type == RUN_PORT_CONTROL) && port->input
+		&& (port->max > port->min);
+}
+
+static float
+_wcet_value(app_t *app, const run_port_t *port, float value)
+{
+	if(value < port->min)
+	{
+		value = port->min;
+	}
+	else if(value > port->max)
+	{
+		value = port->max;
+	}
+
+	if(  lilv_port_has_property(app->plugin, port->port, app->uris.lv2_integer)
+		|| lilv_port_has_property(app->plugin, port->port, app->uris.lv2_toggled) )
+	{
+		return roundf(value);
+	}
+
+	return value;
+}
+
+static uint64_t
+_wcet_evaluate(app_t *app, run_t *run, wcet_case_t *cand, uint32_t *state)
+{
+	cand->ns = 0;
+
+	for(unsigned t = 0; t < WCET_TRIALS; t++)
+	{
+		for(unsigned i = 0; i < run->n_ports; i++)
+		{
+			run_port_t *port = &run->ports[i];
+
+			if(!port->input)
+			{
+				continue;
+			}
+
+			if(_wcet_control(port))
+			{
+				*(float *)port->buf = cand->controls[i];
+			}
+			else if( (port->type == RUN_PORT_AUDIO) || (port->type == RUN_PORT_CV) )
+			{
+				lv2lint_run_signal(port, cand->signal, run->block_length, state);
+			}
+			else if( (port->type == RUN_PORT_ATOM) && (cand->midi != WCET_MIDI_NONE)
+				&& lilv_port_supports_event(app->plugin, port->port, app->uris.midi_MidiEvent) )
+			{
+				_sequence_fill(run, port, cand->midi - WCET_MIDI_NOTES);
+			}
+		}
+
+		const uint64_t ns = lv2lint_run(run, run->block_length);
+
+		// worst case, not best case, is what capacity planning needs
+		if(ns > cand->ns)
+		{
+			cand->ns = ns;
+		}
+	}
+
+	return cand->ns;
+}
+
+static void
+_wcet_mutate(app_t *app, run_t *run, wcet_case_t *cand, uint32_t *state)
+{
+	const uint32_t dim = lv2lint_run_rand(state) % (run->n_ports + 2);
+
+	if(dim == run->n_ports)
+	{
+		cand->signal = lv2lint_run_rand(state) % RUN_SIGNAL_MAX;
+	}
+	else if(dim == run->n_ports + 1)
+	{
+		cand->midi = lv2lint_run_rand(state) % WCET_MIDI_MAX;
+	}
+	else if(_wcet_control(&run->ports[dim]))
+	{
+		const run_port_t *port = &run->ports[dim];
+		const float step = 0.1f * (port->max - port->min) * (2.f*lv2lint_run_uniform(state) - 1.f);
+
+		cand->controls[dim] = _wcet_value(app, port, cand->controls[dim] + step);
+	}
+}
+
+static char *
+_plugin_path(app_t *app, const char *dir, const char *suffix)
+{
+	const char *uri = lilv_node_as_uri(lilv_plugin_get_uri(app->plugin));
+	char *name = malloc(3*strlen(uri) + 1);
+	char *path = NULL;
+
+	if(!name)
+	{
+		return NULL;
+	}
+
+	// percent-encode plugin URI into a single, unique file name
+	char *ptr = name;
+	for(const char *src = uri; *src; src++)
+	{
+		if(isalnum((unsigned char)*src) || (*src == '.') || (*src == '-') || (*src == '_'))
+		{
+			*ptr++ = *src;
+		}
+		else
+		{
+			ptr += sprintf(ptr, "%%%02X", (unsigned char)*src);
+		}
+	}
+	*ptr = '\0';
+
+	if(asprintf(&path, "%s/%s%s", dir, name, suffix) == -1)
+	{
+		path = NULL;
+	}
+
+	free(name);
+
+	return path;
+}
+
+static char *
+_wcet_save(app_t *app, run_t *run, const wcet_case_t *best)
+{
+	char *path = _plugin_path(app, app->wcet_dir, ".wcet");
+	if(!path)
+	{
+		return NULL;
+	}
+
+	FILE *f = fopen(path, "w");
+	if(!f)
+	{
+		free(path);
+		return NULL;
+	}
+
+	fprintf(f,
+		"# lv2lint worst-case execution time case\n"
+		"plugin %s\n"
+		"sample-rate %.0f\n"
+		"block-length %"PRIu32"\n"
+		"seed 0x%08x\n"
+		"run %.3f us\n"
+		"signal %s\n"
+		"midi %s\n",
+		lilv_node_as_uri(lilv_plugin_get_uri(app->plugin)),
+		app->sample_rate, run->block_length, RUN_SEED, best->ns * 1e-3,
+		wcet_signals[best->signal], wcet_midis[best->midi]);
+
+	for(unsigned i = 0; i < run->n_ports; i++)
+	{
+		const run_port_t *port = &run->ports[i];
+
+		if(_wcet_control(port))
+		{
+			fprintf(f, "control %s %g\n",
+				lilv_node_as_string(lilv_port_get_symbol(app->plugin, port->port)),
+				best->controls[i]);
+		}
+	}
+
+	fclose(f);
+
+	return path;
+}
+
+static const ret_t *
+_test_wcet(app_t *app)
+{
+	static const ret_t ret_wcet [] = {
+		{
+			.lnt = LINT_NOTE,
+			.msg = "worst-case execution time: %s",
+			.uri = LV2_CORE__hardRTCapable,
+			.dsc = "Longest run() found by a random and hill-climbing search over "
+				"control values, input signals and MIDI events, relative to the "
+				"duration of a block. Use it as an upper bound for capacity planning."
+		},
+		{
+			.lnt = LINT_WARN,
+			.msg = "worst-case execution time exceeds limit: %s",
+			.uri = LV2_CORE__hardRTCapable,
+			.dsc = "Some combination of control values and input signals makes "
+				"run() take a large part of the block duration. Check the reported "
+				"case, e.g. for denormals or expensive recomputation."
+		}
+	};
+
+	const ret_t *ret = NULL;
+
+	if(!app->perf)
+	{
+		return NULL;
+	}
+
+	run_t *run = lv2lint_run_get(app);
+	if(!run)
+	{
+		return lv2lint_run_skipped(app);
+	}
+
+	const size_t case_size = sizeof(wcet_case_t) + run->n_ports * sizeof(float);
+	wcet_case_t *best = calloc(1, case_size);
+	wcet_case_t *cand = calloc(1, case_size);
+	if(!best || !cand)
+	{
+		free(best);
+		free(cand);
+		return NULL;
+	}
+
+	uint32_t state = RUN_SEED;
+
+	// random search over the whole space
+	for(unsigned r = 0; r < WCET_RANDOM; r++)
+	{
+		for(unsigned i = 0; i < run->n_ports; i++)
+		{
+			const run_port_t *port = &run->ports[i];
+
+			if(_wcet_control(port))
+			{
+				cand->controls[i] = _wcet_value(app, port,
+					port->min + (port->max - port->min) * lv2lint_run_uniform(&state));
+			}
+		}
+
+		cand->signal = lv2lint_run_rand(&state) % RUN_SIGNAL_MAX;
+		cand->midi = lv2lint_run_rand(&state) % WCET_MIDI_MAX;
+
+		if(_wcet_evaluate(app, run, cand, &state) > best->ns)
+		{
+			memcpy(best, cand, case_size);
+		}
+	}
+
+	// hill-climbing from the best random candidate
+	for(unsigned c = 0; c < WCET_CLIMB; c++)
+	{
+		memcpy(cand, best, case_size);
+		_wcet_mutate(app, run, cand, &state);
+
+		if(_wcet_evaluate(app, run, cand, &state) > best->ns)
+		{
+			memcpy(best, cand, case_size);
+		}
+	}
+
+	// release all voices and restore defaults
+	for(unsigned i = 0; i < run->n_ports; i++)
+	{
+		run_port_t *port = &run->ports[i];
+
+		if( (port->type == RUN_PORT_CONTROL) && port->input)
+		{
+			*(float *)port->buf = port->dflt;
+		}
+		else if( (port->type == RUN_PORT_AUDIO) || (port->type == RUN_PORT_CV) )
+		{
+			lv2lint_run_signal(port, RUN_SIGNAL_SILENCE, run->block_length, &state);
+		}
+		else if( (port->type == RUN_PORT_ATOM) && port->input
+			&& lilv_port_supports_event(app->plugin, port->port, app->uris.midi_MidiEvent) )
+		{
+			_sequence_fill(run, port, 3);
+		}
+	}
+	lv2lint_run(run, run->block_length);
+
+	const double block_ns = run->block_length * 1e9 / app->sample_rate;
+	const double load = best->ns * 100.0 / block_ns;
+	const lint_t lnt = lv2lint_limit(app, LIMIT_WCET, load);
+
+	char *path = app->wcet_dir
+		? _wcet_save(app, run, best)
+		: NULL;
+
+	if(asprintf(app->urn, "%.1f us (%.1f%% of block) with %s signal and %s MIDI%s%s",
+		best->ns * 1e-3, load, wcet_signals[best->signal], wcet_midis[best->midi],
+		path ? ", case saved to " : "", path ? path : "") == -1)
+	{
+		*app->urn = NULL;
+	}
+
+	ret = lv2lint_grade(app, lnt, ret_wcet);
+
+	free(path);
+	free(best);
+	free(cand);
+
+	return ret;
+}
+
+static float
+_latency_dot(const float *restrict x, const float *restrict y, uint32_t n)
+{
+	// independent lanes let the compiler vectorize without -ffast-math
+	float acc [8] = {0.f};
+	uint32_t i;
+
+	for(i = 0; i + 8 <= n; i += 8)
+	{
+		for(unsigned j = 0; j < 8; j++)
+		{
+			acc[j] += x[i + j] * y[i + j];
+		}
+	}
+
+	for( ; i < n; i++)
+	{
+		acc[0] += x[i] * y[i];
+	}
+
+	return ( (acc[0] + acc[1]) + (acc[2] + acc[3]) )
+		+ ( (acc[4] + acc[5]) + (acc[6] + acc[7]) );
+}
+
+static void
+_latency_block(run_t *run, run_port_t *excite, const float *x)
+{
+	for(unsigned i = 0; i < run->n_ports; i++)
+	{
+		run_port_t *port = &run->ports[i];
+
+		if( ( (port->type == RUN_PORT_AUDIO) || (port->type == RUN_PORT_CV) )
+			&& port->input)
+		{
+			if( (port == excite) && x)
+			{
+				memcpy(port->buf, x, run->block_length * sizeof(float));
+			}
+			else
+			{
+				memset(port->buf, 0x0, run->block_length * sizeof(float));
+			}
+		}
+	}
+
+	lv2lint_run(run, run->block_length);
+}
+
+static const ret_t *
+_test_latency(app_t *app)
+{
+	static const ret_t ret_latency [] = {
+		{
+			.lnt = LINT_NOTE,
+			.msg = "latency: %s",
+			.uri = LV2_CORE__reportsLatency,
+			.dsc = "Latency reported on the latency port compared to the delay "
+				"measured by cross-correlating a noise burst through the first "
+				"audio input and output."
+		},
+		{
+			.lnt = LINT_WARN,
+			.msg = "reported latency differs from measured delay: %s",
+			.uri = LV2_CORE__reportsLatency,
+			.dsc = "Hosts compensate the reported latency across parallel signal "
+				"paths, wrongly reported values result in phase issues. Report the "
+				"latency in samples the audio path actually has."
+		}
+	};
+
+	const ret_t *ret = NULL;
+
+	if(!lilv_plugin_has_latency(app->plugin))
+	{
+		return NULL;
+	}
+
+	run_t *run = lv2lint_run_get(app);
+	if(!run)
+	{
+		return lv2lint_run_skipped(app);
+	}
+
+	const uint32_t index = lilv_plugin_get_latency_port_index(app->plugin);
+	run_port_t *input = lv2lint_run_port(run, RUN_PORT_AUDIO, true, NULL);
+	run_port_t *output = lv2lint_run_port(run, RUN_PORT_AUDIO, false, NULL);
+	if( (index >= run->n_ports) || (run->ports[index].type != RUN_PORT_CONTROL)
+		|| !input || !output)
+	{
+		return NULL;
+	}
+
+	// query the reported latency
+	_latency_block(run, NULL, NULL);
+	const float reported = *(const float *)run->ports[index].buf;
+	if( !(reported >= 0.f) || (reported > 10.f*app->sample_rate) )
+	{
+		return NULL;
+	}
+
+	const uint32_t nx = run->block_length;
+	const uint32_t nlags = lrintf(reported) + 2*run->block_length;
+	const uint32_t nblocks = (nx + nlags + run->block_length - 1) / run->block_length;
+	float *x = calloc(nx, sizeof(float));
+	float *y = calloc(nblocks * run->block_length, sizeof(float));
+	if(!x || !y)
+	{
+		free(x);
+		free(y);
+		return NULL;
+	}
+
+	uint32_t state = RUN_SEED;
+	float energy = 0.f;
+	for(uint32_t i = 0; i < nx; i++)
+	{
+		x[i] = 2.f*lv2lint_run_uniform(&state) - 1.f;
+		energy += x[i] * x[i];
+	}
+
+	// flush whatever is still in the delay lines
+	for(uint32_t b = 0; b < nblocks; b++)
+	{
+		_latency_block(run, NULL, NULL);
+	}
+
+	// excite with a single block of noise, capture the response
+	for(uint32_t b = 0; b < nblocks; b++)
+	{
+		_latency_block(run, input, (b == 0) ? x : NULL);
+		memcpy(&y[b*run->block_length], output->buf, run->block_length * sizeof(float));
+	}
+
+	uint32_t lag = 0;
+	float peak = 0.f;
+	for(uint32_t k = 0; k < nlags; k++)
+	{
+		const float r = fabsf(_latency_dot(x, &y[k], nx));
+
+		if(r > peak)
+		{
+			peak = r;
+			lag = k;
+		}
+	}
+
+	// only judge when the noise burst made it through the audio path
+	if(peak > 0.01f*energy)
+	{
+		const uint32_t latency = lrintf(reported);
+		const lint_t lnt = lv2lint_limit(app, LIMIT_LATENCY_ERROR,
+			abs((int32_t)lag - (int32_t)latency));
+
+		if(asprintf(app->urn, "reported %"PRIu32" samples, measured %"PRIu32" samples",
+			latency, lag) == -1)
+		{
+			*app->urn = NULL;
+		}
+
+		ret = lv2lint_grade(app, lnt, ret_latency);
+	}
+
+	free(x);
+	free(y);
+
+	return ret;
+}
+
+#define IN_PLACE_BLOCKS    16
+#define IN_PLACE_TOLERANCE 1e-5f // of output peak, about -100 dB
+
+static void
+_in_place_block(run_t *run, const float *x)
+{
+	for(unsigned i = 0; i < run->n_ports; i++)
+	{
+		run_port_t *port = &run->ports[i];
+
+		if( (port->type == RUN_PORT_AUDIO) && port->input)
+		{
+			memcpy(port->buf, x, run->block_length * sizeof(float));
+		}
+	}
+}
+
+static unsigned
+_in_place_alias(run_t *run)
+{
+	unsigned n_pairs = 0;
+
+	// connect k-th audio output to the buffer of the k-th audio input
+	for(unsigned i = 0, o = 0; (i < run->n_ports) && (o < run->n_ports); )
+	{
+		run_port_t *input = &run->ports[i];
+		run_port_t *output = &run->ports[o];
+
+		if( (input->type != RUN_PORT_AUDIO) || !input->input)
+		{
+			i++;
+		}
+		else if( (output->type != RUN_PORT_AUDIO) || output->input)
+		{
+			o++;
+		}
+		else
+		{
+			lv2lint_run_alias(run, input, output);
+			n_pairs++;
+			i++;
+			o++;
+		}
+	}
+
+	return n_pairs;
+}
+
+static const run_port_t *
+_in_place_compare(run_t *separate, run_t *other, float *peak, float *deviation)
+{
+	const run_port_t *differs = NULL;
+
+	for(unsigned i = 0; i < separate->n_ports; i++)
+	{
+		const run_port_t *port = &separate->ports[i];
+
+		if( (port->type != RUN_PORT_AUDIO) || port->input)
+		{
+			continue;
+		}
+
+		const float *a = port->buf;
+		const float *b = lv2lint_run_buffer(other, i);
+
+		for(uint32_t j = 0; j < separate->block_length; j++)
+		{
+			// NaN on one side only counts as infinite deviation
+			const float diff = (isnan(a[j]) && isnan(b[j]))
+				? 0.f
+				: isnan(a[j] - b[j])
+					? INFINITY
+					: fabsf(a[j] - b[j]);
+
+			if(fabsf(a[j]) > *peak)
+			{
+				*peak = fabsf(a[j]);
+			}
+
+			if(diff > *deviation)
+			{
+				*deviation = diff;
+				differs = port;
+			}
+		}
+	}
+
+	return differs;
+}
+
+static const ret_t *
+_test_in_place(app_t *app)
+{
+	static const ret_t ret_in_place_differs = {
+		.lnt = LINT_FAIL,
+		.msg = "output differs when processing audio in-place: %s",
+		.uri = LV2_CORE__inPlaceBroken,
+		.dsc = "Hosts may connect audio inputs and outputs to the same buffer, "
+			"unless a plugin declares lv2:inPlaceBroken. Either read all inputs "
+			"before writing to outputs, or declare the feature."
+	},
+	ret_in_place_nondeterministic = {
+		.lnt = LINT_NOTE,
+		.msg = "output differs between identical instances, in-place processing not verified: %s",
+		.uri = LV2_CORE__inPlaceBroken,
+		.dsc = "Two instances with separate buffers and identical input already "
+			"produce different output, e.g. due to random or time-based "
+			"modulation, thus aliased buffers cannot be told apart by comparison."
+	},
+	ret_in_place = {
+		.lnt = LINT_NOTE,
+		.msg = "in-place processing: %s",
+		.uri = LV2_CORE__inPlaceBroken,
+		.dsc = "run() cost with separate compared to aliased audio buffers. "
+			"Hosts processing in-place save cache traffic of a whole buffer per port."
+	};
+
+	const ret_t *ret = NULL;
+
+	if(!app->perf || !app->instance
+		|| lilv_plugin_has_feature(app->plugin, app->uris.lv2_inPlaceBroken))
+	{
+		return NULL;
+	}
+
+	// fresh instances with identical history, the control one tells whether
+	// the plugin is deterministic at all
+	run_t *separate = lv2lint_run_new(app);
+	run_t *control = lv2lint_run_new(app);
+	run_t *aliased = lv2lint_run_new(app);
+	float *x = calloc(app->block_length, sizeof(float));
+
+	if(separate && control && aliased && x && _in_place_alias(aliased))
+	{
+		uint32_t state = RUN_SEED;
+		uint64_t ns_separate = 0;
+		uint64_t ns_aliased = 0;
+		float peak = 0.f;
+		float deviation = 0.f;
+		float noise = 0.f;
+		const run_port_t *differs = NULL;
+		const run_port_t *varies = NULL;
+
+		for(unsigned b = 0; b < IN_PLACE_BLOCKS; b++)
+		{
+			for(uint32_t j = 0; j < app->block_length; j++)
+			{
+				x[j] = 2.f*lv2lint_run_uniform(&state) - 1.f;
+			}
+
+			_in_place_block(separate, x);
+			_in_place_block(control, x);
+			_in_place_block(aliased, x);
+
+			ns_separate += lv2lint_run(separate, separate->block_length);
+			lv2lint_run(control, control->block_length);
+			ns_aliased += lv2lint_run(aliased, aliased->block_length);
+
+			const run_port_t *port = _in_place_compare(separate, aliased, &peak,
+				&deviation);
+			if(port)
+			{
+				differs = port;
+			}
+
+			port = _in_place_compare(separate, control, &peak, &noise);
+			if(port)
+			{
+				varies = port;
+			}
+		}
+
+		const float tolerance = IN_PLACE_TOLERANCE * peak;
+
+		if(noise > tolerance)
+		{
+			const LilvNode *symbol = lilv_port_get_symbol(app->plugin, varies->port);
+
+			if(asprintf(app->urn, "%s varies by up to %g",
+				lilv_node_as_string(symbol), noise) == -1)
+			{
+				*app->urn = NULL;
+			}
+
+			ret = &ret_in_place_nondeterministic;
+		}
+		else if(deviation > tolerance)
+		{
+			const LilvNode *symbol = lilv_port_get_symbol(app->plugin, differs->port);
+
+			if(asprintf(app->urn, "%s deviates by up to %g",
+				lilv_node_as_string(symbol), deviation) == -1)
+			{
+				*app->urn = NULL;
+			}
+
+			ret = &ret_in_place_differs;
+		}
+		else
+		{
+			const double separate_us = ns_separate * 1e-3 / IN_PLACE_BLOCKS;
+			const double aliased_us = ns_aliased * 1e-3 / IN_PLACE_BLOCKS;
+			const double change = (separate_us > 0.0)
+				? 100.0 * (aliased_us - separate_us) / separate_us
+				: 0.0;
+
+			if(asprintf(app->urn, "separate %.1f us, in-place %.1f us per block (%+.1f%%)",
+				separate_us, aliased_us, change) == -1)
+			{
+				*app->urn = NULL;
+			}
+
+			ret = &ret_in_place;
+		}
+	}
+
+	free(x);
+	lv2lint_run_free(separate);
+	lv2lint_run_free(control);
+	lv2lint_run_free(aliased);
+
+	return ret;
+}
+
+#define SCALING_BLOCKS 256 // per instance and measurement
+#define SCALING_WARMUP 16
+
+typedef struct _scaling_t scaling_t;
+
+struct _scaling_t {
+	run_t *run;
+	pthread_t thread;
+	unsigned cpu;
+	const atomic_bool *start;
+	bool pinned;
+	uint64_t ns;
+};
+
+static void *
+_scaling_thread(void *data)
+{
+	scaling_t *scaling = data;
+
+#if defined(__linux__)
+	cpu_set_t cpuset;
+
+	CPU_ZERO(&cpuset);
+	CPU_SET(scaling->cpu, &cpuset);
+	scaling->pinned = !pthread_setaffinity_np(pthread_self(), sizeof(cpuset), &cpuset);
+#else
+	scaling->pinned = false; // left to the scheduler
+#endif
+
+	// start all instances at once
+	while(!atomic_load_explicit(scaling->start, memory_order_acquire))
+	{
+		sched_yield();
+	}
+
+	const uint64_t t0 = lv2lint_now();
+	for(unsigned b = 0; b < SCALING_BLOCKS; b++)
+	{
+		lv2lint_run(scaling->run, scaling->run->block_length);
+	}
+	scaling->ns = lv2lint_now() - t0;
+
+	return NULL;
+}
+
+static uint64_t
+_scaling_measure(scaling_t *scalings, unsigned n)
+{
+	atomic_bool start = false;
+	unsigned n_started = 0;
+	uint64_t wall = 0;
+
+	for( ; n_started < n; n_started++)
+	{
+		scaling_t *scaling = &scalings[n_started];
+
+		scaling->start = &start;
+		scaling->ns = 0;
+
+		if(pthread_create(&scaling->thread, NULL, _scaling_thread, scaling))
+		{
+			break;
+		}
+	}
+
+	atomic_store_explicit(&start, true, memory_order_release);
+
+	for(unsigned i = 0; i < n_started; i++)
+	{
+		scaling_t *scaling = &scalings[i];
+
+		pthread_join(scaling->thread, NULL);
+
+		if(scaling->ns > wall)
+		{
+			wall = scaling->ns;
+		}
+	}
+
+	return (n_started == n) ? wall : 0;
+}
+
+static const ret_t *
+_test_scaling(app_t *app)
+{
+	static const ret_t ret_scaling [] = {
+		{
+			.lnt = LINT_NOTE,
+			.msg = "multi-instance scaling: %s",
+			.uri = LV2_CORE__hardRTCapable,
+			.dsc = "Aggregate throughput of concurrent instances on pinned threads, "
+				"and the scaling efficiency against a single instance."
+		},
+		{
+			.lnt = LINT_WARN,
+			.msg = "multi-instance scaling exceeds limit: %s",
+			.uri = LV2_CORE__hardRTCapable,
+			.dsc = "Instances slow each other down when run concurrently. Look out "
+				"for shared global state, static locks or false sharing between "
+				"instances, e.g. of global tables written to in run()."
+		}
+	};
+
+	const ret_t *ret = NULL;
+
+	if(!app->perf || (app->threads < 2) || !app->instance)
+	{
+		return NULL;
+	}
+
+	const long n_cpus = lv2lint_cpus();
+	const unsigned n = app->threads;
+	scaling_t *scalings = calloc(n, sizeof(scaling_t));
+	if(!scalings || (n_cpus < 1) )
+	{
+		free(scalings);
+		return NULL;
+	}
+
+	uint32_t state = RUN_SEED;
+	unsigned n_runs = 0;
+
+	for( ; n_runs < n; n_runs++)
+	{
+		scaling_t *scaling = &scalings[n_runs];
+
+		scaling->run = lv2lint_run_new(app);
+		if(!scaling->run)
+		{
+			break;
+		}
+
+		scaling->cpu = n_runs % n_cpus;
+
+		for(unsigned i = 0; i < scaling->run->n_ports; i++)
+		{
+			run_port_t *port = &scaling->run->ports[i];
+
+			if( (port->type == RUN_PORT_AUDIO) && port->input)
+			{
+				lv2lint_run_signal(port, RUN_SIGNAL_NOISE, scaling->run->block_length, &state);
+			}
+		}
+
+		for(unsigned b = 0; b < SCALING_WARMUP; b++)
+		{
+			lv2lint_run(scaling->run, scaling->run->block_length);
+		}
+	}
+
+	const uint64_t single = (n_runs == n)
+		? _scaling_measure(scalings, 1)
+		: 0;
+	const uint64_t wall = single
+		? _scaling_measure(scalings, n)
+		: 0;
+
+	if(wall)
+	{
+		// oversubscribed cores cannot do better than time slicing
+		const unsigned rounds = (n + n_cpus - 1) / n_cpus;
+		const double efficiency = (double)single * rounds / wall;
+		const double loss = (efficiency < 1.0)
+			? 100.0 * (1.0 - efficiency)
+			: 0.0;
+		const double block_s = scalings[0].run->block_length / app->sample_rate;
+		const double realtime = n * SCALING_BLOCKS * block_s / (wall * 1e-9);
+
+		bool pinned = true;
+		for(unsigned i = 0; i < n; i++)
+		{
+			pinned = pinned && scalings[i].pinned;
+		}
+
+		const lint_t lnt = lv2lint_limit(app, LIMIT_SCALING_LOSS, loss);
+
+		if(asprintf(app->urn, "%u instances on %ld cores%s, %.1fx realtime, "
+			"%.0f%% efficiency", n, n_cpus, pinned ? "" : " (not pinned)",
+			realtime, 100.0 * efficiency) == -1)
+		{
+			*app->urn = NULL;
+		}
+
+		ret = lv2lint_grade(app, lnt, ret_scaling);
+	}
+
+	for(unsigned i = 0; i < n_runs; i++)
+	{
+		lv2lint_run_free(scalings[i].run);
+	}
+	free(scalings);
+
+	return ret;
+}
+
+#define DEADLINE_DURATION 2 // s of simulated audio
+#define DEADLINE_PRIORITY 80 // SCHED_FIFO, above typical IRQ threads
+#define STRESS_SIZE       (64 << 20) // bytes streamed over per memory stressor
+
+typedef struct _deadline_t deadline_t;
+typedef struct _stressor_t stressor_t;
+
+struct _deadline_t {
+	run_t *run;
+	uint64_t period; // ns
+	unsigned n_blocks;
+	unsigned cpu;
+	unsigned misses;
+	uint64_t max_wakeup; // ns from period start to wake-up
+	uint64_t max_response; // ns from period start to end of run()
+	double sum_response;
+	double sum_response2;
+};
+
+struct _stressor_t {
+	pthread_t thread;
+	unsigned cpu;
+	uint8_t *buf; // memory stressor, NULL for CPU stressor
+	const atomic_bool *stop;
+};
+
+static volatile double stress_sink; // keeps stressors from being optimized out
+
+static void
+_pin(unsigned cpu)
+{
+#if defined(__linux__)
+	cpu_set_t cpuset;
+
+	CPU_ZERO(&cpuset);
+	CPU_SET(cpu, &cpuset);
+	pthread_setaffinity_np(pthread_self(), sizeof(cpuset), &cpuset);
+#else
+	(void)cpu; // left to the scheduler
+#endif
+}
+
+static void *
+_stressor_thread(void *data)
+{
+	stressor_t *stressor = data;
+	double acc = 1.0;
+
+	_pin(stressor->cpu);
+
+	while(!atomic_load_explicit(stressor->stop, memory_order_relaxed))
+	{
+		if(stressor->buf)
+		{
+			// saturate memory bandwidth and thrash the shared cache
+			for(size_t i = 0; i < STRESS_SIZE; i += 64)
+			{
+				stressor->buf[i]++;
+			}
+		}
+		else
+		{
+			for(unsigned i = 0; i < 0x10000; i++)
+			{
+				acc = acc * 1.0000001 + 1e-9;
+			}
+		}
+	}
+
+	stress_sink = acc;
+
+	return NULL;
+}
+
+static void
+_deadline_sleep(uint64_t ns)
+{
+#if defined(__linux__)
+	const struct timespec ts = {
+		.tv_sec = ns / 1000000000ULL,
+		.tv_nsec = ns % 1000000000ULL
+	};
+
+	while(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR)
+	{
+		// try again
+	}
+#else
+	// no absolute sleep, wake-up latency includes the relative error
+	const uint64_t now = lv2lint_now();
+
+	if(ns > now)
+	{
+		const struct timespec ts = {
+			.tv_sec = (ns - now) / 1000000000ULL,
+			.tv_nsec = (ns - now) % 1000000000ULL
+		};
+
+		nanosleep(&ts, NULL);
+	}
+#endif
+}
+
+static void *
+_deadline_thread(void *data)
+{
+	deadline_t *deadline = data;
+	run_t *run = deadline->run;
+	uint32_t state = RUN_SEED;
+
+	_pin(deadline->cpu);
+
+	uint64_t start = lv2lint_now() + deadline->period;
+
+	for(unsigned b = 0; b < deadline->n_blocks; b++)
+	{
+		// prepare input of next period ahead of time, like a driver would
+		for(unsigned i = 0; i < run->n_ports; i++)
+		{
+			run_port_t *port = &run->ports[i];
+
+			if( (port->type == RUN_PORT_AUDIO) && port->input)
+			{
+				lv2lint_run_signal(port, RUN_SIGNAL_NOISE, run->block_length, &state);
+			}
+		}
+
+		_deadline_sleep(start);
+
+		const uint64_t wakeup = lv2lint_now() - start;
+		lv2lint_run(run, run->block_length);
+		const uint64_t end = lv2lint_now();
+		const uint64_t response = end - start;
+
+		if(wakeup > deadline->max_wakeup)
+		{
+			deadline->max_wakeup = wakeup;
+		}
+		if(response > deadline->max_response)
+		{
+			deadline->max_response = response;
+		}
+		deadline->sum_response += response;
+		deadline->sum_response2 += (double)response * response;
+
+		start += deadline->period;
+
+		if(end > start)
+		{
+			// an xrun, the host would drop the late period and resynchronize
+			deadline->misses++;
+			start = end + deadline->period;
+		}
+	}
+
+	return NULL;
+}
+
+static bool
+_deadline_spawn(pthread_t *thread, deadline_t *deadline, bool *rt)
+{
+	*rt = false;
+
+#if defined(__linux__)
+	pthread_attr_t attr;
+	struct sched_param param;
+
+	memset(&param, 0x0, sizeof(param));
+	param.sched_priority = DEADLINE_PRIORITY;
+
+	if(!pthread_attr_init(&attr))
+	{
+		if(!pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED)
+			&& !pthread_attr_setschedpolicy(&attr, SCHED_FIFO)
+			&& !pthread_attr_setschedparam(&attr, &param) )
+		{
+			*rt = !pthread_create(thread, &attr, _deadline_thread, deadline);
+		}
+
+		pthread_attr_destroy(&attr);
+	}
+#endif
+
+	// without real-time privileges, measure under the default scheduler
+	if(!*rt && pthread_create(thread, NULL, _deadline_thread, deadline))
+	{
+		return false;
+	}
+
+	return true;
+}
+
+static const ret_t *
+_test_deadline(app_t *app)
+{
+	static const ret_t ret_deadline [] = {
+		{
+			.lnt = LINT_NOTE,
+			.msg = "real-time deadlines: %s",
+			.uri = LV2_CORE__hardRTCapable,
+			.dsc = "The plugin run from a simulated audio callback thread, woken "
+				"once per block period with the end of the period as deadline."
+		},
+		{
+			.lnt = LINT_WARN,
+			.msg = "real-time deadlines missed: %s",
+			.uri = LV2_CORE__hardRTCapable,
+			.dsc = "The plugin did not finish run() within the block period, which "
+				"makes a host xrun. Look out for occasional expensive blocks, "
+				"e.g. due to allocations, locks, I/O or costly parameter updates, "
+				"and for memory-bound processing hit by background load."
+		}
+	};
+
+	const ret_t *ret = NULL;
+
+	if(!app->perf || !app->instance)
+	{
+		return NULL;
+	}
+
+	const long n_cpus = lv2lint_cpus();
+	const unsigned n_stressors = app->stress_cpu + app->stress_mem;
+	stressor_t *stressors = calloc(n_stressors + 1, sizeof(stressor_t));
+	if(!stressors || (n_cpus < 1) )
+	{
+		free(stressors);
+		return NULL;
+	}
+
+	deadline_t deadline;
+	memset(&deadline, 0x0, sizeof(deadline));
+	deadline.run = lv2lint_run_new(app);
+	if(!deadline.run)
+	{
+		free(stressors);
+		return NULL;
+	}
+	deadline.period = deadline.run->block_length * 1e9 / app->sample_rate;
+	deadline.n_blocks = DEADLINE_DURATION * app->sample_rate
+		/ deadline.run->block_length;
+	deadline.cpu = 0;
+
+	// background load on all other cores
+	atomic_bool stop = false;
+	unsigned n_started = 0;
+
+	for( ; n_started < n_stressors; n_started++)
+	{
+		stressor_t *stressor = &stressors[n_started];
+
+		stressor->cpu = (n_cpus > 1)
+			? 1 + n_started % (n_cpus - 1)
+			: 0;
+		stressor->stop = &stop;
+
+		if(n_started >= app->stress_cpu)
+		{
+			stressor->buf = calloc(STRESS_SIZE, 1);
+			if(!stressor->buf)
+			{
+				break;
+			}
+		}
+
+		if(pthread_create(&stressor->thread, NULL, _stressor_thread, stressor))
+		{
+			free(stressor->buf);
+			stressor->buf = NULL;
+			break;
+		}
+	}
+
+	pthread_t thread;
+	bool rt = false;
+	const bool spawned = _deadline_spawn(&thread, &deadline, &rt);
+
+	if(spawned)
+	{
+		pthread_join(thread, NULL);
+	}
+
+	atomic_store_explicit(&stop, true, memory_order_relaxed);
+	for(unsigned i = 0; i < n_started; i++)
+	{
+		pthread_join(stressors[i].thread, NULL);
+		free(stressors[i].buf);
+	}
+	free(stressors);
+
+	if(spawned && deadline.n_blocks)
+	{
+		const double mean = deadline.sum_response / deadline.n_blocks;
+		const double var = deadline.sum_response2 / deadline.n_blocks - mean*mean;
+		const double jitter = (var > 0.0) ? sqrt(var) : 0.0;
+
+		// misses under the default scheduler tell more about the machine
+		const lint_t lnt = rt
+			? lv2lint_limit(app, LIMIT_DEADLINE, deadline.misses)
+			: LINT_NOTE;
+#if defined(__linux__)
+		const char *sched = rt ? "SCHED_FIFO" : "no real-time privileges";
+#else
+		const char *sched = "default scheduler, not pinned";
+#endif
+
+		if(asprintf(app->urn, "%u of %u missed (%s, %u CPU and %u memory "
+			"stressors), response %.1f +- %.1f us, max %.1f us of %.1f us period, "
+			"max wake-up latency %.1f us",
+			deadline.misses, deadline.n_blocks, sched,
+			app->stress_cpu, app->stress_mem, mean * 1e-3, jitter * 1e-3,
+			deadline.max_response * 1e-3, deadline.period * 1e-3,
+			deadline.max_wakeup * 1e-3) == -1)
+		{
+			*app->urn = NULL;
+		}
+
+		ret = lv2lint_grade(app, lnt, ret_deadline);
+	}
+
+	lv2lint_run_free(deadline.run);
+
+	return ret;
+}
+
+#if defined(__linux__) // helper processes are re-executed via /proc/self/exe
+#define LOAD_INSTANCES 32
+#define LOAD_TIMEOUT   30 // s
+
+typedef struct _load_pool_t load_pool_t;
+
+struct _load_pool_t {
+	app_t *app;
+	const LilvState *state; // reference state, if any
+	atomic_uint next;
+	LilvInstance *instances [LOAD_INSTANCES];
+	bool differs [LOAD_INSTANCES];
+};
+
+typedef struct _load_result_t load_result_t;
+
+struct _load_result_t {
+	bool deterministic;
+	unsigned n_differ;
+	uint64_t ns_sequential;
+	uint64_t ns_parallel;
+};
+
+static const void *
+_load_get_value(const char *symbol __unused, void *data __unused,
+	uint32_t *size, uint32_t *type)
+{
+	// port values are not part of the comparison
+	*size = 0;
+	*type = 0;
+
+	return NULL;
+}
+
+static void
+_load_set_value(const char *symbol __unused, void *data __unused,
+	const void *value __unused, uint32_t size __unused, uint32_t type __unused)
+{
+	// port values are not part of the comparison
+}
+
+static LilvState *
+_load_save(app_t *app, LilvInstance *instance)
+{
+	return lilv_state_new_from_instance(app->plugin, instance, app->map,
+		NULL, NULL, NULL, NULL, _load_get_value, NULL,
+		LV2_STATE_IS_POD | LV2_STATE_IS_PORTABLE, app->features);
+}
+
+static void
+_load_task(load_pool_t *pool, unsigned i)
+{
+	app_t *app = pool->app;
+
+	LilvInstance *instance = lilv_plugin_instantiate(app->plugin,
+		app->sample_rate, app->features);
+
+	pool->instances[i] = instance;
+	pool->differs[i] = !instance;
+
+	if(instance && pool->state)
+	{
+		lilv_state_restore(pool->state, instance, _load_set_value, NULL,
+			LV2_STATE_IS_POD | LV2_STATE_IS_PORTABLE, app->features);
+
+		LilvState *state = _load_save(app, instance);
+
+		pool->differs[i] = !state || !lilv_state_equals(state, pool->state);
+
+		lilv_state_free(state);
+	}
+}
+
+static void *
+_load_thread(void *data)
+{
+	load_pool_t *pool = data;
+	unsigned i;
+
+	while( (i = atomic_fetch_add(&pool->next, 1)) < LOAD_INSTANCES)
+	{
+		_load_task(pool, i);
+	}
+
+	return NULL;
+}
+
+static unsigned
+_load_finish(load_pool_t *pool)
+{
+	unsigned n_differ = 0;
+
+	for(unsigned i = 0; i < LOAD_INSTANCES; i++)
+	{
+		if(pool->differs[i])
+		{
+			n_differ++;
+		}
+
+		if(pool->instances[i])
+		{
+			lilv_instance_free(pool->instances[i]);
+			pool->instances[i] = NULL;
+		}
+	}
+
+	return n_differ;
+}
+
+static unsigned
+_load_threads(app_t *app)
+{
+	const long n_cpus = lv2lint_cpus();
+
+	return (app->threads > 1)
+		? app->threads
+		: ( (n_cpus > 8) ? 8 : (n_cpus > 2) ? n_cpus : 2);
+}
+
+static bool
+_load_helper(app_t *app)
+{
+	const unsigned n_threads = _load_threads(app);
+	load_pool_t pool;
+	load_result_t result;
+	pthread_t threads [n_threads];
+
+	alarm(LOAD_TIMEOUT);
+
+	// reference state saved from the main instance
+	LilvState *state = app->state_iface
+		? _load_save(app, app->instance)
+		: NULL;
+
+	memset(&pool, 0x0, sizeof(pool));
+	memset(&result, 0x0, sizeof(result));
+	pool.app = app;
+	pool.state = state;
+
+	// session-style loading, one instance after the other
+	uint64_t t0 = lv2lint_now();
+	for(unsigned i = 0; i < LOAD_INSTANCES; i++)
+	{
+		_load_task(&pool, i);
+	}
+	result.ns_sequential = lv2lint_now() - t0;
+	result.deterministic = (_load_finish(&pool) == 0);
+
+	// one result per phase tells the parent where a crash happened
+	if(!lv2lint_helper_write(app, &result, sizeof(result)))
+	{
+		lilv_state_free(state);
+		return false;
+	}
+
+	// parallel session loading from a thread pool
+	atomic_store(&pool.next, 0);
+
+	unsigned n_started = 0;
+	t0 = lv2lint_now();
+	for( ; n_started < n_threads; n_started++)
+	{
+		if(pthread_create(&threads[n_started], NULL, _load_thread, &pool))
+		{
+			break;
+		}
+	}
+
+	_load_thread(&pool); // help out in case thread creation failed
+
+	for(unsigned i = 0; i < n_started; i++)
+	{
+		pthread_join(threads[i], NULL);
+	}
+	result.ns_parallel = lv2lint_now() - t0;
+	result.n_differ = _load_finish(&pool);
+
+	lilv_state_free(state);
+
+	return lv2lint_helper_write(app, &result, sizeof(result));
+}
+
+static const ret_t *
+_test_parallel_load(app_t *app)
+{
+	static const ret_t ret_crash_sequential = {
+		.lnt = LINT_FAIL,
+		.msg = "repeated instantiation and state restore failed: %s",
+		.uri = LV2_CORE_URI,
+		.dsc = "Instantiating and restoring many instances one after the other, "
+			"as hosts do when loading sessions, crashed or hung."
+	},
+	ret_helper = {
+		.lnt = LINT_WARN,
+		.msg = "concurrent instantiation and state restore could not be tested: %s",
+		.uri = LV2_CORE_URI,
+		.dsc = "The helper process did not instantiate the plugin or did not "
+			"report back."
+	},
+	ret_crash = {
+		.lnt = LINT_FAIL,
+		.msg = "concurrent instantiation and state restore failed: %s",
+		.uri = LV2_CORE_URI,
+		.dsc = "Hosts instantiate and restore plugins from multiple threads "
+			"when loading sessions. Separate instances must not share unprotected "
+			"global state, e.g. in lazily initialized static tables."
+	},
+	ret_differs = {
+		.lnt = LINT_WARN,
+		.msg = "concurrent instantiation and state restore differs: %s",
+		.uri = LV2_STATE__interface,
+		.dsc = "Instances instantiated and restored concurrently fail to "
+			"instantiate or save a different state than instances loaded one after "
+			"the other, which hints at unprotected global state."
+	},
+	ret_parallel_load = {
+		.lnt = LINT_NOTE,
+		.msg = "parallel load: %s",
+		.uri = LV2_CORE_URI,
+		.dsc = "Session-style loading of many instances, instantiating them and "
+			"restoring their state one after the other compared to a thread pool."
+	};
+
+	const ret_t *ret = NULL;
+
+	if(!app->perf || !app->instance)
+	{
+		return NULL;
+	}
+
+	const unsigned n_threads = _load_threads(app);
+
+	// isolate crashes and deadlocks in a freshly executed helper process, as
+	// forking this multithreaded one would leave locks held in the child
+	int fd = -1;
+	const pid_t pid = lv2lint_helper_spawn(app, HELPER_LOAD, &fd);
+	if(pid == -1)
+	{
+		return NULL;
+	}
+
+	load_result_t result;
+	unsigned n_phases = 0;
+
+	memset(&result, 0x0, sizeof(result));
+	while( (n_phases < 2) && lv2lint_helper_read(fd, &result, sizeof(result)) )
+	{
+		n_phases++;
+	}
+	close(fd);
+
+	int status = 0;
+	if(lv2lint_helper_wait(pid, &status))
+	{
+		if(WIFSIGNALED(status))
+		{
+			if(asprintf(app->urn, "%s while loading %s",
+				(WTERMSIG(status) == SIGALRM) ? "timeout" : strsignal(WTERMSIG(status)),
+				n_phases ? "in parallel" : "sequentially") == -1)
+			{
+				*app->urn = NULL;
+			}
+
+			ret = n_phases
+				? &ret_crash
+				: &ret_crash_sequential;
+		}
+		else if(!WIFEXITED(status) || WEXITSTATUS(status) || (n_phases < 2) )
+		{
+			if(asprintf(app->urn, "helper exited with status %d after %u of 2 phases",
+				WIFEXITED(status) ? WEXITSTATUS(status) : -1, n_phases) == -1)
+			{
+				*app->urn = NULL;
+			}
+
+			ret = &ret_helper;
+		}
+		else if(result.deterministic && result.n_differ)
+		{
+			if(asprintf(app->urn, "%u of %u instances", result.n_differ,
+				LOAD_INSTANCES) == -1)
+			{
+				*app->urn = NULL;
+			}
+
+			ret = &ret_differs;
+		}
+		else if(result.ns_parallel)
+		{
+			const double sequential_ms = result.ns_sequential * 1e-6;
+			const double parallel_ms = result.ns_parallel * 1e-6;
+
+			if(asprintf(app->urn, "%u instances on %u threads, sequential %.1f ms, "
+				"parallel %.1f ms, %.1fx speedup", LOAD_INSTANCES, n_threads,
+				sequential_ms, parallel_ms, sequential_ms / parallel_ms) == -1)
+			{
+				*app->urn = NULL;
+			}
+
+			ret = &ret_parallel_load;
+		}
+	}
+
+	return ret;
+}
+
+#define ALIGN_CLASSES 4
+#define ALIGN_BLOCKS  128 // per class, the cheapest one counts
+#define ALIGN_WARMUP  8
+#define ALIGN_TIMEOUT 10 // s
+
+static const size_t align_classes [ALIGN_CLASSES] = {
+	64, 32, 16,
+	4 // e.g. at odd sub-block offsets when splitting for automation
+};
+
+static uint64_t
+_align_class(app_t *app, size_t alignment)
+{
+	run_t *run = lv2lint_run_new(app);
+	if(!run)
+	{
+		return 0;
+	}
+
+	lv2lint_run_align(run, alignment);
+
+	uint32_t state = RUN_SEED;
+	uint64_t min = UINT64_MAX;
+
+	for(unsigned b = 0; b < ALIGN_WARMUP + ALIGN_BLOCKS; b++)
+	{
+		for(unsigned i = 0; i < run->n_ports; i++)
+		{
+			run_port_t *port = &run->ports[i];
+
+			if( (port->type == RUN_PORT_AUDIO) && port->input)
+			{
+				lv2lint_run_signal(port, RUN_SIGNAL_NOISE, run->block_length, &state);
+			}
+		}
+
+		const uint64_t dt = lv2lint_run(run, run->block_length);
+
+		if( (b >= ALIGN_WARMUP) && (dt < min) )
+		{
+			min = dt;
+		}
+	}
+
+	lv2lint_run_free(run);
+
+	return (min == UINT64_MAX)
+		? 1 // ran fine, but was not measured
+		: min;
+}
+
+static bool
+_align_helper(app_t *app)
+{
+	for(unsigned c = 0; c < ALIGN_CLASSES; c++)
+	{
+		alarm(ALIGN_TIMEOUT);
+
+		// one result per class tells the parent where a crash happened
+		const uint64_t ns = _align_class(app, align_classes[c]);
+
+		if(!ns || !lv2lint_helper_write(app, &ns, sizeof(ns)) )
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static const ret_t *
+_test_alignment(app_t *app)
+{
+	static const ret_t ret_crash = {
+		.lnt = LINT_FAIL,
+		.msg = "run() crashes with less aligned buffers: %s",
+		.uri = LV2_CORE__AudioPort,
+		.dsc = "Hosts hand out audio buffers aligned to 16 or 32 bytes, or only to "
+			"a single float at sub-block offsets. Use unaligned loads and stores "
+			"(e.g. _mm_loadu_ps) or check the alignment before entering an "
+			"aligned SIMD path."
+	},
+	ret_helper = {
+		.lnt = LINT_WARN,
+		.msg = "buffer alignment could not be tested: %s",
+		.uri = LV2_CORE__AudioPort,
+		.dsc = "The helper process instantiated the plugin, but exited before it "
+			"reported on all alignment classes."
+	},
+	ret_alignment [] = {
+		{
+			.lnt = LINT_NOTE,
+			.msg = "buffer alignment: %s",
+			.uri = LV2_CORE__AudioPort,
+			.dsc = "Cost of run() with audio and CV buffers aligned to 64, 32, 16 "
+				"and only 4 bytes."
+		},
+		{
+			.lnt = LINT_WARN,
+			.msg = "buffer alignment slowdown exceeds limit: %s",
+			.uri = LV2_CORE__AudioPort,
+			.dsc = "run() is considerably slower with less aligned buffers, as "
+				"passed by hosts splitting blocks. Prefer unaligned loads and "
+				"stores, which are as fast as aligned ones on aligned data on "
+				"current CPUs, or process a scalar prologue up to an aligned "
+				"address."
+		}
+	};
+
+	const ret_t *ret = NULL;
+
+	if(!app->perf || !app->instance)
+	{
+		return NULL;
+	}
+
+	// isolate crashes of aligned SIMD loads in a freshly executed helper
+	// process, as forking this multithreaded one would leave locks held
+	int fd = -1;
+	const pid_t pid = lv2lint_helper_spawn(app, HELPER_ALIGN, &fd);
+	if(pid == -1)
+	{
+		return NULL;
+	}
+
+	uint64_t ns [ALIGN_CLASSES];
+	unsigned n_classes = 0;
+
+	memset(ns, 0x0, sizeof(ns));
+	while( (n_classes < ALIGN_CLASSES)
+		&& lv2lint_helper_read(fd, &ns[n_classes], sizeof(uint64_t)) )
+	{
+		n_classes++;
+	}
+	close(fd);
+
+	int status = 0;
+	if(!lv2lint_helper_wait(pid, &status))
+	{
+		return NULL;
+	}
+
+	if(WIFSIGNALED(status))
+	{
+		if(asprintf(app->urn, "%s at %zu-byte alignment",
+			(WTERMSIG(status) == SIGALRM) ? "timeout" : strsignal(WTERMSIG(status)),
+			align_classes[n_classes < ALIGN_CLASSES ? n_classes : ALIGN_CLASSES - 1]) == -1)
+		{
+			*app->urn = NULL;
+		}
+
+		ret = &ret_crash;
+	}
+	else if(WIFEXITED(status) && WEXITSTATUS(status) && !n_classes)
+	{
+		return NULL; // helper did not get to run the plugin, skip
+	}
+	else if(!WIFEXITED(status) || WEXITSTATUS(status) || (n_classes < ALIGN_CLASSES) )
+	{
+		if(asprintf(app->urn, "helper exited with status %d after %u of %u classes",
+			WIFEXITED(status) ? WEXITSTATUS(status) : -1, n_classes, ALIGN_CLASSES) == -1)
+		{
+			*app->urn = NULL;
+		}
+
+		ret = &ret_helper;
+	}
+	else if(ns[0] > 1)
+	{
+		char *classes = NULL;
+		double loss = 0.0;
+
+		for(unsigned c = 0; c < ALIGN_CLASSES; c++)
+		{
+			if(ns[c] <= 1)
+			{
+				continue; // not measured
+			}
+
+			const double diff = 100.0 * ((double)ns[c] / ns[0] - 1.0);
+			char *tmp = NULL;
+
+			if(diff > loss)
+			{
+				loss = diff;
+			}
+
+			if(asprintf(&tmp, "%s%s%zu: %.1f us (%+.0f%%)", classes ? classes : "",
+				classes ? ", " : "", align_classes[c], ns[c] * 1e-3, diff) == -1)
+			{
+				tmp = NULL;
+			}
+
+			free(classes);
+			classes = tmp;
+		}
+
+		const lint_t lnt = lv2lint_limit(app, LIMIT_ALIGNMENT, loss);
+
+		*app->urn = classes;
+		ret = lv2lint_grade(app, lnt, ret_alignment);
+	}
+
+	return ret;
+}
+#endif
+
+#define SPLIT_BLOCKS 16 // of maximal length
+
+static const uint32_t split_lengths [] = {
+	1, 7, 64, 3, 128, 13, 256, 31, 2, 97, 5, 512, 19, 1024, 47
+};
+
+static const uint32_t split_lengths_power_of_2 [] = {
+	1, 64, 2, 128, 8, 256, 4, 512, 16, 1024, 32
+};
+
+static void
+_split_deviation(const float *restrict a, const float *restrict b, uint32_t n,
+	float *peak, float *deviation)
+{
+	uint32_t p = 0;
+	uint32_t d = 0;
+
+	// magnitudes of floats order like their bit patterns, which in contrast to
+	// floats lets the compiler vectorize the reduction without -ffast-math
+	for(uint32_t i = 0; i < n; i++)
+	{
+		const float diff = a[i] - b[i];
+		uint32_t pa;
+		uint32_t da;
+
+		memcpy(&pa, &a[i], sizeof(float));
+		memcpy(&da, &diff, sizeof(float));
+		pa &= 0x7fffffff;
+		da &= 0x7fffffff;
+
+		p = (pa > p) ? pa : p;
+		d = (da > d) ? da : d;
+	}
+
+	memcpy(peak, &p, sizeof(float));
+	memcpy(deviation, &d, sizeof(float));
+}
+
+static void
+_split_render(run_t *run, const float *x, float *y, uint32_t nsamples,
+	const uint32_t *lengths, unsigned n_lengths)
+{
+	for(uint32_t offset = 0, l = 0; offset < nsamples; l++)
+	{
+		uint32_t len = lengths ? lengths[l % n_lengths] : run->block_length;
+
+		if(len > nsamples - offset)
+		{
+			len = nsamples - offset;
+		}
+
+		for(unsigned i = 0; i < run->n_ports; i++)
+		{
+			run_port_t *port = &run->ports[i];
+
+			if( (port->type == RUN_PORT_AUDIO) && port->input)
+			{
+				memcpy(port->buf, &x[offset], len * sizeof(float));
+			}
+		}
+
+		lv2lint_run(run, len);
+
+		// outputs are stored one after the other
+		for(unsigned i = 0, o = 0; i < run->n_ports; i++)
+		{
+			const run_port_t *port = &run->ports[i];
+
+			if( (port->type == RUN_PORT_AUDIO) && !port->input)
+			{
+				memcpy(&y[o++*nsamples + offset], port->buf, len * sizeof(float));
+			}
+		}
+
+		offset += len;
+	}
+}
+
+static const ret_t *
+_test_block_split(app_t *app)
+{
+	static const ret_t ret_block_split [] = {
+		{
+			.lnt = LINT_NOTE,
+			.msg = "block split invariance: %s",
+			.uri = LV2_BUF_SIZE__boundedBlockLength,
+			.dsc = "Deviation of the output when rendering the same input in "
+				"maximal blocks and in small, irregular blocks, relative to its peak."
+		},
+		{
+			.lnt = LINT_WARN,
+			.msg = "block split invariance exceeds limit: %s",
+			.uri = LV2_BUF_SIZE__boundedBlockLength,
+			.dsc = "The output depends on the block length chosen by the host, "
+				"which breaks reproducibility of freezing and bouncing. Process "
+				"parameter changes and smoothing per sample or in fixed sub-blocks."
+		}
+	};
+
+	const ret_t *ret = NULL;
+
+	if(!app->perf || !app->instance
+		|| lilv_plugin_has_feature(app->plugin, app->uris.bufsz_fixedBlockLength)
+		|| lilv_plugin_has_feature(app->plugin, app->uris.bufsz_coarseBlockLength) )
+	{
+		return NULL;
+	}
+
+	const bool power_of_2 = lilv_plugin_has_feature(app->plugin,
+		app->uris.bufsz_powerOf2BlockLength);
+	const uint32_t *candidates = power_of_2
+		? split_lengths_power_of_2
+		: split_lengths;
+	const unsigned n_candidates = power_of_2
+		? sizeof(split_lengths_power_of_2) / sizeof(uint32_t)
+		: sizeof(split_lengths) / sizeof(uint32_t);
+
+	// only lengths within the announced range, i.e. up to the maximum
+	uint32_t lengths [n_candidates];
+	unsigned n_lengths = 0;
+
+	for(unsigned i = 0; i < n_candidates; i++)
+	{
+		if(candidates[i] <= app->block_length)
+		{
+			lengths[n_lengths++] = candidates[i];
+		}
+	}
+
+	const uint32_t n_outputs = lilv_plugin_get_num_ports_of_class(app->plugin,
+		app->uris.lv2_AudioPort, app->uris.lv2_OutputPort, NULL);
+	const uint32_t nsamples = SPLIT_BLOCKS * app->block_length;
+
+	// fresh instances with identical history
+	run_t *whole = lv2lint_run_new(app);
+	run_t *split = lv2lint_run_new(app);
+	float *x = calloc(nsamples, sizeof(float));
+	float *y_whole = calloc(n_outputs * nsamples, sizeof(float));
+	float *y_split = calloc(n_outputs * nsamples, sizeof(float));
+
+	if(n_outputs && whole && split && x && y_whole && y_split)
+	{
+		uint32_t state = RUN_SEED;
+		for(uint32_t i = 0; i < nsamples; i++)
+		{
+			x[i] = 2.f*lv2lint_run_uniform(&state) - 1.f;
+		}
+
+		_split_render(whole, x, y_whole, nsamples, NULL, 0);
+		_split_render(split, x, y_split, nsamples, lengths, n_lengths);
+
+		float peak = 0.f;
+		float deviation = 0.f;
+		_split_deviation(y_whole, y_split, n_outputs * nsamples, &peak, &deviation);
+
+		if(deviation == 0.f)
+		{
+			*app->urn = strdup("bit-exact");
+			ret = lv2lint_grade(app, lv2lint_limit(app, LIMIT_SPLIT_ERROR, -INFINITY),
+				ret_block_split);
+		}
+		else
+		{
+			// deviation of silent output or NaN counts as full-scale
+			const double error_db = (deviation < peak)
+				? 20.0 * log10(deviation / peak)
+				: 0.0;
+
+			if(asprintf(app->urn, "%.1f dB", error_db) == -1)
+			{
+				*app->urn = NULL;
+			}
+
+			ret = lv2lint_grade(app, lv2lint_limit(app, LIMIT_SPLIT_ERROR, error_db),
+				ret_block_split);
+		}
+	}
+
+	free(x);
+	free(y_whole);
+	free(y_split);
+	lv2lint_run_free(whole);
+	lv2lint_run_free(split);
+
+	return ret;
+}
+
+#define FINGERPRINT_BLOCKS   16 // per stimulus
+#define FINGERPRINT_SEGMENTS 16 // RMS envelope values per stimulus and output
+#define FINGERPRINT_FLOOR    -90.0 // dB, considered silent below
+
+typedef enum _fingerprint_stimulus_t {
+	FINGERPRINT_SILENCE,
+	FINGERPRINT_IMPULSE,
+	FINGERPRINT_NOISE,
+	FINGERPRINT_SWEEP,
+
+	FINGERPRINT_MAX
+} fingerprint_stimulus_t;
+
+static const char *fingerprint_stimuli [FINGERPRINT_MAX] = {
+	[FINGERPRINT_SILENCE] = "silence",
+	[FINGERPRINT_IMPULSE] = "impulse",
+	[FINGERPRINT_NOISE]   = "noise",
+	[FINGERPRINT_SWEEP]   = "sweep"
+};
+
+typedef struct _fingerprint_t fingerprint_t;
+
+struct _fingerprint_t {
+	unsigned minor_version;
+	unsigned micro_version;
+	uint32_t n_outputs;
+	const char **symbols; // of audio outputs
+	double *envelopes; // [stimulus][output][segment] in dB
+};
+
+static unsigned
+_fingerprint_version(app_t *app, const LilvNode *predicate)
+{
+	unsigned version = 0;
+
+	LilvNodes *version_nodes = lilv_plugin_get_value(app->plugin, predicate);
+	if(version_nodes)
+	{
+		const LilvNode *version_node = lilv_nodes_get_first(version_nodes);
+		if(version_node && lilv_node_is_int(version_node))
+		{
+			version = lilv_node_as_int(version_node);
+		}
+
+		lilv_nodes_free(version_nodes);
+	}
+
+	return version;
+}
+
+static double *
+_fingerprint_envelope(const fingerprint_t *fp, unsigned stimulus, uint32_t output)
+{
+	return &fp->envelopes[(stimulus*fp->n_outputs + output) * FINGERPRINT_SEGMENTS];
+}
+
+static void
+_fingerprint_stimulus(float *x, uint32_t nsamples, unsigned stimulus,
+	float sample_rate)
+{
+	uint32_t state = RUN_SEED;
+	double phase = 0.0;
+
+	for(uint32_t i = 0; i < nsamples; i++)
+	{
+		switch(stimulus)
+		{
+			case FINGERPRINT_SILENCE:
+				x[i] = 0.f;
+				break;
+			case FINGERPRINT_IMPULSE:
+				x[i] = (i == 0) ? 1.f : 0.f;
+				break;
+			case FINGERPRINT_NOISE:
+				x[i] = 0.5f*(2.f*lv2lint_run_uniform(&state) - 1.f);
+				break;
+			case FINGERPRINT_SWEEP:
+				// logarithmic sine sweep from 20 Hz to 20 kHz
+				x[i] = 0.5f*sin(phase);
+				phase += 2.0*M_PI * 20.0 * pow(1000.0, (double)i / nsamples) / sample_rate;
+				break;
+		}
+	}
+}
+
+static bool
+_fingerprint_render(app_t *app, fingerprint_t *fp)
+{
+	const uint32_t nsamples = FINGERPRINT_BLOCKS * app->block_length;
+	const uint32_t nsegment = nsamples / FINGERPRINT_SEGMENTS;
+	bool success = false;
+
+	// a fresh instance renders all stimuli one after the other
+	run_t *run = lv2lint_run_new(app);
+	float *x = calloc(nsamples, sizeof(float));
+	float *y = calloc(fp->n_outputs * nsamples, sizeof(float));
+
+	if(run && x && y)
+	{
+		for(uint32_t i = 0, o = 0; i < run->n_ports; i++)
+		{
+			const run_port_t *port = &run->ports[i];
+
+			if( (port->type == RUN_PORT_AUDIO) && !port->input)
+			{
+				fp->symbols[o++] = lilv_node_as_string(
+					lilv_port_get_symbol(app->plugin, port->port));
+			}
+		}
+
+		for(unsigned s = 0; s < FINGERPRINT_MAX; s++)
+		{
+			_fingerprint_stimulus(x, nsamples, s, app->sample_rate);
+			_split_render(run, x, y, nsamples, NULL, 0);
+
+			for(uint32_t o = 0; o < fp->n_outputs; o++)
+			{
+				double *envelope = _fingerprint_envelope(fp, s, o);
+
+				for(unsigned g = 0; g < FINGERPRINT_SEGMENTS; g++)
+				{
+					const float *seg = &y[o*nsamples + g*nsegment];
+					double sum = 0.0;
+
+					for(uint32_t i = 0; i < nsegment; i++)
+					{
+						sum += seg[i] * seg[i];
+					}
+
+					const double rms_db = 10.0 * log10(sum / nsegment);
+
+					envelope[g] = (rms_db > FINGERPRINT_FLOOR)
+						? rms_db
+						: FINGERPRINT_FLOOR; // also catches NaN
+				}
+			}
+		}
+
+		success = true;
+	}
+
+	free(x);
+	free(y);
+	lv2lint_run_free(run);
+
+	return success;
+}
+
+static void
+_fingerprint_save(app_t *app, const fingerprint_t *fp, const char *path)
+{
+	FILE *f = fopen(path, "w");
+	if(!f)
+	{
+		return;
+	}
+
+	fprintf(f,
+		"# lv2lint output fingerprint\n"
+		"plugin %s\n"
+		"version %u.%u\n"
+		"sample-rate %.0f\n"
+		"block-length %"PRIu32"\n",
+		lilv_node_as_uri(lilv_plugin_get_uri(app->plugin)),
+		fp->minor_version, fp->micro_version, app->sample_rate, app->block_length);
+
+	for(unsigned s = 0; s < FINGERPRINT_MAX; s++)
+	{
+		for(uint32_t o = 0; o < fp->n_outputs; o++)
+		{
+			const double *envelope = _fingerprint_envelope(fp, s, o);
+
+			fprintf(f, "%s %s", fingerprint_stimuli[s], fp->symbols[o]);
+
+			for(unsigned g = 0; g < FINGERPRINT_SEGMENTS; g++)
+			{
+				fprintf(f, " %.2f", envelope[g]);
+			}
+
+			fprintf(f, "\n");
+		}
+	}
+
+	fclose(f);
+}
+
+static bool
+_fingerprint_compare(app_t *app, const fingerprint_t *fp, const char *path,
+	double *deviation, char **where, char **mismatch)
+{
+	FILE *f = fopen(path, "r");
+	if(!f)
+	{
+		return false;
+	}
+
+	char line [1024];
+	float sample_rate = 0.f;
+	uint32_t block_length = 0;
+	bool compared = false;
+
+	while(fgets(line, sizeof(line), f))
+	{
+		char stimulus [32];
+		char symbol [256];
+		int pos = 0;
+
+		if(sscanf(line, "sample-rate %f", &sample_rate) == 1)
+		{
+			continue;
+		}
+		else if(sscanf(line, "block-length %"SCNu32, &block_length) == 1)
+		{
+			continue;
+		}
+		else if( (line[0] == '#')
+			|| (sscanf(line, "%31s %255s%n", stimulus, symbol, &pos) != 2) )
+		{
+			continue;
+		}
+
+		// envelopes are only comparable when rendered the same way
+		if( (sample_rate != app->sample_rate) || (block_length != app->block_length) )
+		{
+			if(asprintf(mismatch, "rendered at %.0f Hz and %"PRIu32" samples, "
+				"now at %.0f Hz and %"PRIu32" samples", sample_rate, block_length,
+				app->sample_rate, app->block_length) == -1)
+			{
+				*mismatch = NULL;
+			}
+
+			break;
+		}
+
+		for(unsigned s = 0; s < FINGERPRINT_MAX; s++)
+		{
+			if(strcmp(stimulus, fingerprint_stimuli[s]))
+			{
+				continue;
+			}
+
+			for(uint32_t o = 0; o < fp->n_outputs; o++)
+			{
+				if(strcmp(symbol, fp->symbols[o]))
+				{
+					continue;
+				}
+
+				const double *envelope = _fingerprint_envelope(fp, s, o);
+				const char *ptr = &line[pos];
+
+				for(unsigned g = 0; g < FINGERPRINT_SEGMENTS; g++)
+				{
+					char *end = NULL;
+					const double golden = strtod(ptr, &end);
+
+					if(end == ptr)
+					{
+						break;
+					}
+					ptr = end;
+
+					const double diff = fabs(envelope[g] - golden);
+					compared = true;
+
+					if(diff > *deviation)
+					{
+						*deviation = diff;
+						free(*where);
+						if(asprintf(where, "%s at %s", stimulus, symbol) == -1)
+						{
+							*where = NULL;
+						}
+					}
+				}
+			}
+		}
+	}
+
+	fclose(f);
+
+	return compared;
+}
+
+static char *
+_fingerprint_reference(app_t *app, const fingerprint_t *fp, unsigned *minor,
+	unsigned *micro)
+{
+	char *path = NULL;
+
+#if !defined(_WIN32)
+	char *pattern = _plugin_path(app, app->fingerprint_dir, ".*.*.fp");
+	glob_t pglob;
+
+	if(!pattern)
+	{
+		return NULL;
+	}
+
+	const size_t prefix = strlen(pattern) - strlen("*.*.fp");
+
+	// pick the most recent version up to the current one
+	if(glob(pattern, 0, NULL, &pglob) == 0)
+	{
+		for(size_t i = 0; i < pglob.gl_pathc; i++)
+		{
+			const char *candidate = pglob.gl_pathv[i];
+			unsigned mi;
+			unsigned mu;
+			int pos = 0;
+
+			if( (sscanf(&candidate[prefix], "%u.%u.fp%n", &mi, &mu, &pos) != 2)
+				|| candidate[prefix + pos] )
+			{
+				continue;
+			}
+
+			if( (mi > fp->minor_version)
+				|| ( (mi == fp->minor_version) && (mu > fp->micro_version) ) )
+			{
+				continue;
+			}
+
+			if(!path || (mi > *minor) || ( (mi == *minor) && (mu > *micro) ) )
+			{
+				free(path);
+				path = strdup(candidate);
+				*minor = mi;
+				*micro = mu;
+			}
+		}
+
+		globfree(&pglob);
+	}
+
+	free(pattern);
+#else
+	// without glob, only the current version is looked up
+	char *suffix = NULL;
+
+	if(asprintf(&suffix, ".%u.%u.fp", fp->minor_version, fp->micro_version) == -1)
+	{
+		return NULL;
+	}
+
+	path = _plugin_path(app, app->fingerprint_dir, suffix);
+	free(suffix);
+
+	if(path && access(path, F_OK))
+	{
+		free(path);
+		path = NULL;
+	}
+	else if(path)
+	{
+		*minor = fp->minor_version;
+		*micro = fp->micro_version;
+	}
+#endif
+
+	return path;
+}
+
+static const ret_t *
+_test_fingerprint(app_t *app)
+{
+	static const ret_t ret_stored = {
+		.lnt = LINT_NOTE,
+		.msg = "output fingerprint stored: %s",
+		.uri = LV2_CORE__microVersion,
+		.dsc = "Envelopes of the output for a fixed set of stimuli are stored per "
+			"plugin version as a reference for later releases."
+	},
+	ret_mismatch = {
+		.lnt = LINT_WARN,
+		.msg = "output fingerprint not comparable: %s",
+		.uri = LV2_CORE__microVersion,
+		.dsc = "The stored fingerprint was rendered with a different sample rate "
+			"or block length, e.g. by another version of lv2lint. Remove it to "
+			"store a new one."
+	},
+	ret_fingerprint [] = {
+		{
+			.lnt = LINT_NOTE,
+			.msg = "output fingerprint: %s",
+			.uri = LV2_CORE__microVersion,
+			.dsc = "Deviation of output envelopes for a fixed set of stimuli from "
+				"the stored fingerprint of the same or a previous version."
+		},
+		{
+			.lnt = LINT_WARN,
+			.msg = "output fingerprint exceeds limit: %s",
+			.uri = LV2_CORE__microVersion,
+			.dsc = "The output of the plugin changed audibly compared to the stored "
+				"fingerprint. Make sure this is intended and bump the version, users "
+				"expect their sessions to sound the same after an upgrade."
+		}
+	};
+
+	const ret_t *ret = NULL;
+
+	if(!app->fingerprint_dir || !app->instance)
+	{
+		return NULL;
+	}
+
+	fingerprint_t fp = {
+		.minor_version = _fingerprint_version(app, app->uris.lv2_minorVersion),
+		.micro_version = _fingerprint_version(app, app->uris.lv2_microVersion),
+		.n_outputs = lilv_plugin_get_num_ports_of_class(app->plugin,
+			app->uris.lv2_AudioPort, app->uris.lv2_OutputPort, NULL)
+	};
+
+	if(fp.n_outputs == 0)
+	{
+		return NULL;
+	}
+
+	fp.symbols = calloc(fp.n_outputs, sizeof(const char *));
+	fp.envelopes = calloc(FINGERPRINT_MAX * fp.n_outputs * FINGERPRINT_SEGMENTS,
+		sizeof(double));
+
+	char *suffix = NULL;
+	if(asprintf(&suffix, ".%u.%u.fp", fp.minor_version, fp.micro_version) == -1)
+	{
+		suffix = NULL;
+	}
+	char *path = suffix
+		? _plugin_path(app, app->fingerprint_dir, suffix)
+		: NULL;
+
+	if(path && fp.symbols && fp.envelopes && _fingerprint_render(app, &fp))
+	{
+		unsigned minor = 0;
+		unsigned micro = 0;
+		char *reference = _fingerprint_reference(app, &fp, &minor, &micro);
+		double deviation = 0.0;
+		char *where = NULL;
+		char *mismatch = NULL;
+
+		if(reference && _fingerprint_compare(app, &fp, reference, &deviation, &where,
+			&mismatch))
+		{
+			const lint_t lnt = lv2lint_limit(app, LIMIT_FINGERPRINT, deviation);
+
+			if(asprintf(app->urn, "%.1f dB vs. version %u.%u%s%s", deviation,
+				minor, micro, where ? " with " : "", where ? where : "") == -1)
+			{
+				*app->urn = NULL;
+			}
+
+			ret = lv2lint_grade(app, lnt, ret_fingerprint);
+		}
+		else if(mismatch)
+		{
+			if(asprintf(app->urn, "version %u.%u %s", minor, micro, mismatch) == -1)
+			{
+				*app->urn = NULL;
+			}
+
+			ret = &ret_mismatch;
+		}
+
+		// never overwrite the golden fingerprint of a version
+		if(access(path, F_OK) != 0)
+		{
+			_fingerprint_save(app, &fp, path);
+
+			if(!ret)
+			{
+				*app->urn = strdup(path);
+				ret = &ret_stored;
+			}
+		}
+
+		free(where);
+		free(mismatch);
+		free(reference);
+	}
+
+	free(path);
+	free(suffix);
+	free(fp.symbols);
+	free(fp.envelopes);
+
+	return ret;
+}
+
+#define BOUNDS_BLOCKS 16
+
+static const ret_t *
+_test_port_bounds(app_t *app)
+{
+	static const ret_t ret_fault = {
+		.lnt = LINT_FAIL,
+		.msg = "run() accesses past end of port buffer: %s",
+		.uri = LV2_CORE__Port,
+		.dsc = "Port buffers are only as large as the block length, resp. the "
+			"announced atom capacity. Hosts pool buffers of all plugins, an "
+			"overrun thus corrupts the buffers of other plugins."
+	},
+	ret_overrun = {
+		.lnt = LINT_FAIL,
+		.msg = "run() writes more samples than requested: %s",
+		.uri = LV2_CORE__Port,
+		.dsc = "run() must only process sample_count samples, which may be less "
+			"than the maximal block length, e.g. when hosts split blocks at "
+			"automation events."
+	};
+
+	const ret_t *ret = NULL;
+
+	if(!app->perf || !app->instance)
+	{
+		return NULL;
+	}
+
+	run_t *run = lv2lint_run_new(app);
+	if(!run)
+	{
+		return NULL;
+	}
+
+	// short blocks are within the minimum announced to the instance, unless
+	// the plugin requires blocks of the nominal length
+	const bool fixed = lilv_plugin_has_feature(app->plugin,
+			app->uris.bufsz_fixedBlockLength)
+		|| lilv_plugin_has_feature(app->plugin, app->uris.bufsz_coarseBlockLength);
+	const bool power_of_2 = lilv_plugin_has_feature(app->plugin,
+		app->uris.bufsz_powerOf2BlockLength);
+
+	uint32_t state = RUN_SEED;
+
+	for(unsigned b = 0; (b < BOUNDS_BLOCKS) && (run->fault == -1); b++)
+	{
+		// alternate full and odd-sized short blocks
+		const uint32_t nsamples = ( (b & 1) && !fixed )
+			? (run->block_length >> (b & 3)) - (power_of_2 ? 0 : 1)
+			: run->block_length;
+
+		for(unsigned i = 0; i < run->n_ports; i++)
+		{
+			run_port_t *port = &run->ports[i];
+
+			if( (port->type == RUN_PORT_AUDIO) && port->input)
+			{
+				lv2lint_run_signal(port, RUN_SIGNAL_NOISE, run->block_length, &state);
+			}
+			else if( (port->type == RUN_PORT_ATOM) && port->input
+				&& lilv_port_supports_event(app->plugin, port->port, app->uris.midi_MidiEvent) )
+			{
+				_sequence_fill(run, port, b);
+			}
+		}
+
+		lv2lint_run(run, nsamples);
+	}
+
+	const int index = (run->fault != -1)
+		? run->fault
+		: run->overrun;
+
+	if(index != -1)
+	{
+		const LilvNode *symbol = lilv_port_get_symbol(app->plugin,
+			run->ports[index].port);
+
+		// guard pages catch reads and writes alike
+		if(asprintf(app->urn, "%s port %d (%s)",
+			run->ports[index].input ? "input" : "output",
+			index, lilv_node_as_string(symbol)) == -1)
+		{
+			*app->urn = NULL;
+		}
+
+		ret = (run->fault != -1)
+			? &ret_fault
+			: &ret_overrun;
+	}
+
+	lv2lint_run_free(run);
+
+	return ret;
+}
+
+#define COUNTER_BLOCKS 64
+
+static const ret_t *
+_test_counters(app_t *app)
+{
+	static const ret_t ret_counters [] = {
+		{
+			.lnt = LINT_NOTE,
+			.msg = "hardware counters: %s",
+			.uri = LV2_CORE__hardRTCapable,
+			.dsc = "Hardware performance counters of run() in user space while "
+				"processing noise. Instruction counts are stable across runs, even "
+				"on shared machines, and thus well suited to track regressions."
+		},
+		{
+			.lnt = LINT_WARN,
+			.msg = "hardware counters exceed limit: %s",
+			.uri = LV2_CORE__hardRTCapable,
+			.dsc = "run() executes many instructions per sample. Check for "
+				"unnecessary per-sample recomputation and whether the compiler "
+				"managed to vectorize the inner loops."
+		}
+	};
+
+	const ret_t *ret = NULL;
+
+	if(!app->perf)
+	{
+		return NULL;
+	}
+
+	run_t *run = lv2lint_run_get(app);
+	if(!run)
+	{
+		return lv2lint_run_skipped(app);
+	}
+
+	if(!lv2lint_run_counters(run))
+	{
+		return NULL;
+	}
+
+	uint32_t state = RUN_SEED;
+	uint64_t sums [RUN_COUNTER_MAX] = {0};
+
+	for(unsigned b = 0; b < COUNTER_BLOCKS; b++)
+	{
+		for(unsigned i = 0; i < run->n_ports; i++)
+		{
+			run_port_t *port = &run->ports[i];
+
+			if( (port->type == RUN_PORT_AUDIO) && port->input)
+			{
+				lv2lint_run_signal(port, RUN_SIGNAL_NOISE, run->block_length, &state);
+			}
+		}
+
+		lv2lint_run(run, run->block_length);
+
+		for(unsigned c = 0; c < RUN_COUNTER_MAX; c++)
+		{
+			sums[c] += run->counters[c];
+		}
+	}
+
+	if(sums[RUN_COUNTER_CYCLES] == 0)
+	{
+		return NULL;
+	}
+
+	const double instructions = (double)sums[RUN_COUNTER_INSTRUCTIONS]
+		/ (COUNTER_BLOCKS * run->block_length);
+	const double ipc = (double)sums[RUN_COUNTER_INSTRUCTIONS]
+		/ sums[RUN_COUNTER_CYCLES];
+	const double cache_misses = (double)sums[RUN_COUNTER_CACHE_MISSES]
+		/ COUNTER_BLOCKS;
+	const double branch_misses = (double)sums[RUN_COUNTER_BRANCH_MISSES]
+		/ COUNTER_BLOCKS;
+
+	const lint_t lnt = lv2lint_limit(app, LIMIT_INSTRUCTIONS, instructions);
+
+	if(asprintf(app->urn, "%.1f instructions/sample, IPC %.2f, "
+		"%.1f cache misses/block, %.1f branch misses/block",
+		instructions, ipc, cache_misses, branch_misses) == -1)
+	{
+		*app->urn = NULL;
+	}
+
+	ret = lv2lint_grade(app, lnt, ret_counters);
+
+	return ret;
+}
+
+#define PROFILE_DURATION 1000000000ULL // ns of thread CPU time
+#define PROFILE_BLOCKS   (1 << 16)
+
+static uint64_t
+_profile_cpu_time(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+
+	return ts.tv_sec*1000000000ULL + ts.tv_nsec;
+}
+
+static const ret_t *
+_test_profile(app_t *app)
+{
+	static const ret_t ret_profile = {
+		.lnt = LINT_NOTE,
+		.msg = "call stacks of run(): %s",
+		.uri = LV2_CORE__binary,
+		.dsc = "Call stacks of run() sampled on a CPU-time profiling timer while "
+			"processing noise, saved in folded format. Feed the file to flame "
+			"graph tools to see where the plugin spends its time. Stacks are "
+			"unwound with the DWARF call frame information of the binary, so "
+			"do not strip .eh_frame, and keep .symtab to name local functions."
+	};
+	static const ret_t ret_failed = {
+		.lnt = LINT_WARN,
+		.msg = "call stacks of run() could not be sampled: %s",
+		.uri = LV2_CORE__binary,
+		.dsc = "Either the profiling timer could not be armed or run() returned "
+			"too quickly to be sampled at all."
+	};
+
+	const ret_t *ret = NULL;
+
+	if(!app->profile_dir || !app->instance)
+	{
+		return NULL;
+	}
+
+	run_t *run = lv2lint_run_get(app);
+	if(!run)
+	{
+		return lv2lint_run_skipped(app);
+	}
+
+	char *path = _plugin_path(app, app->profile_dir, ".folded");
+	if(!path)
+	{
+		return NULL;
+	}
+
+	// frames are attributed to the plugin by the base address of the library
+	// its descriptor lives in
+	const void *base = NULL;
+#if defined(__GLIBC__)
+	const LV2_Descriptor *descriptor = lilv_instance_get_descriptor(app->instance);
+	Dl_info info;
+	if(dladdr(descriptor, &info))
+	{
+		base = info.dli_fbase;
+	}
+#endif
+
+	const void *symtab = NULL;
+#ifdef ENABLE_ELF_TESTS
+	symtab = app->symtab;
+#endif
+
+	FILE *f = fopen(path, "w");
+	if(!f)
+	{
+		*app->urn = strdup(strerror(errno));
+		ret = &ret_failed;
+	}
+	else if(!lv2lint_profile_start())
+	{
+		*app->urn = strdup("profiling timer unavailable");
+		ret = &ret_failed;
+		fclose(f);
+	}
+	else
+	{
+		uint32_t state = RUN_SEED;
+		const uint64_t t0 = _profile_cpu_time();
+
+		for(unsigned b = 0;
+			(b < PROFILE_BLOCKS) && (_profile_cpu_time() - t0 < PROFILE_DURATION);
+			b++)
+		{
+			for(unsigned i = 0; i < run->n_ports; i++)
+			{
+				run_port_t *port = &run->ports[i];
+
+				if( (port->type == RUN_PORT_AUDIO) && port->input)
+				{
+					lv2lint_run_signal(port, RUN_SIGNAL_NOISE, run->block_length, &state);
+				}
+			}
+
+			lv2lint_run(run, run->block_length);
+		}
+
+		lv2lint_profile_stop();
+
+		char *hottest = NULL;
+		unsigned n_hottest = 0;
+		const unsigned n = lv2lint_profile_write(f, base, symtab, &hottest,
+			&n_hottest);
+
+		fclose(f);
+
+		if(n == 0)
+		{
+			*app->urn = strdup("no samples taken inside of plugin");
+			ret = &ret_failed;
+		}
+		else
+		{
+			if(asprintf(app->urn, "%u samples, hottest %s (%.0f%%), written to %s",
+				n, hottest ? hottest : "[unknown]", 100.0 * n_hottest / n, path) == -1)
+			{
+				*app->urn = NULL;
+			}
+
+			ret = &ret_profile;
+		}
+
+		free(hottest);
+	}
+
+	free(path);
+
+	return ret;
+}
+
+#define CACHE_BLOCKS   64
+#define CACHE_EVICTION (64 << 20) // bytes, if the last level cache size is unknown
+
+static volatile uint8_t cache_sink; // keeps eviction from being optimized out
+
+static void
+_cache_evict(uint8_t *buf, size_t size)
+{
+	uint8_t acc = 0;
+
+	// stream over the buffer, dirtying every cache line on the way
+	for(size_t i = 0; i < size; i += 64)
+	{
+		acc += buf[i];
+		buf[i] = acc;
+	}
+
+	cache_sink = acc;
+}
+
+static void
+_cache_inputs(run_t *run, uint32_t *state)
+{
+	for(unsigned i = 0; i < run->n_ports; i++)
+	{
+		run_port_t *port = &run->ports[i];
+
+		if( (port->type == RUN_PORT_AUDIO) && port->input)
+		{
+			lv2lint_run_signal(port, RUN_SIGNAL_NOISE, run->block_length, state);
+		}
+	}
+}
+
+static double
+_cache_block(run_t *run, uint32_t *state, uint8_t *evict, size_t size)
+{
+	// emulate the other plugins of a host running in between
+	if(evict)
+	{
+		_cache_evict(evict, size);
+	}
+
+	// the host writes the inputs last, so only they are hot
+	_cache_inputs(run, state);
+
+	return lv2lint_run(run, run->block_length) * 1e-3;
+}
+
+static const ret_t *
+_test_cache(app_t *app)
+{
+	static const ret_t ret_cache = {
+		.lnt = LINT_NOTE,
+		.msg = "cache sensitivity: %s",
+		.uri = LV2_CORE__hardRTCapable,
+		.dsc = "Cost of run() with caches evicted before each block, as in a host "
+			"running many other plugins in between, compared to back-to-back "
+			"blocks, and the data touched by a single run() call. Shrink "
+			"working sets (e.g. float instead of double tables, smaller delay "
+			"lines) to reduce cold-cache cost."
+	};
+
+	const ret_t *ret = NULL;
+
+	if(!app->perf)
+	{
+		return NULL;
+	}
+
+	run_t *run = lv2lint_run_get(app);
+	if(!run)
+	{
+		return lv2lint_run_skipped(app);
+	}
+
+	// evict twice the size of the last level cache
+	size_t size = CACHE_EVICTION;
+#if defined(_SC_LEVEL3_CACHE_SIZE)
+	const long llc = sysconf(_SC_LEVEL3_CACHE_SIZE);
+	if(llc > 0)
+	{
+		size = 2 * (size_t)llc;
+	}
+#endif
+
+	uint8_t *evict = malloc(size);
+	if(!evict)
+	{
+		return NULL;
+	}
+	memset(evict, 0x0, size);
+
+	uint32_t state = RUN_SEED;
+	double warm_us = 0.0;
+	double cold_us = 0.0;
+
+	_cache_block(run, &state, NULL, 0); // warm up
+	for(unsigned b = 0; b < CACHE_BLOCKS; b++)
+	{
+		warm_us += _cache_block(run, &state, NULL, 0);
+	}
+	for(unsigned b = 0; b < CACHE_BLOCKS; b++)
+	{
+		cold_us += _cache_block(run, &state, evict, size);
+	}
+
+	free(evict);
+
+	warm_us /= CACHE_BLOCKS;
+	cold_us /= CACHE_BLOCKS;
+
+	// subtract what the harness around run() and reading the page tables
+	// touch themselves, with the inputs generated beforehand
+	_cache_inputs(run, &state);
+	lv2lint_mem_refs_clear();
+	lv2lint_run_touch(run);
+	const int64_t baseline = lv2lint_mem_refs();
+	lv2lint_mem_refs_clear();
+	lv2lint_run(run, run->block_length);
+	int64_t working_set = lv2lint_mem_refs() - baseline;
+	if(working_set < 0)
+	{
+		working_set = 0;
+	}
+
+	const double period_us = run->block_length * 1e6 / app->sample_rate;
+
+	if(asprintf(app->urn, "warm %.1f us, cold %.1f us (%.1fx), "
+		"%.0f cold instances per core, data working set ~%"PRIi64" KiB",
+		warm_us, cold_us, (warm_us > 0.0) ? cold_us / warm_us : 0.0,
+		(cold_us > 0.0) ? floor(period_us / cold_us) : 0.0,
+		working_set / 1024) == -1)
+	{
+		*app->urn = NULL;
+	}
+
+	ret = &ret_cache;
+
+	return ret;
+}
+
+#ifdef ENABLE_ELF_TESTS
+static const ret_t *
+_test_symbols(app_t *app)
+{
+	static const ret_t ret_symbols = {
+		.lnt = LINT_FAIL,
+		.msg = "binary exports superfluous globally visible symbols: %s",
+		.uri = LV2_CORE__binary,
+		.dsc = "Plugin binaries must not export any globally visible symbols "
+			 "but lv2_descriptor. You may well have forgotten to compile "
+			 "with -fvisibility=hidden."
+	};
+
+	const ret_t *ret = NULL;
+
+	const LilvNode* node = lilv_plugin_get_library_uri(app->plugin);
+	if(node && lilv_node_is_uri(node))
+	{
+		const char *uri = lilv_node_as_uri(node);
+		if(uri)
+		{
+			char *path = lilv_file_uri_parse(uri, NULL);
+			if(path)
+			{
+				char *symbols = NULL;
+
+				// keep function symbols around for symbolization of profiles
+				app->symtab = calloc(1, sizeof(symtab_t));
+
+				if(!test_visibility(path, "lv2_descriptor", &symbols, app->symtab))
+				{
+					*app->urn = symbols;
+					ret = &ret_symbols;
+				}
+				else if(symbols)
+				{
+					free(symbols);
+				}
+
+				lilv_free(path);
+			}
+		}
+	}
+
+	return ret;
+}
+
+static const ret_t *
+_test_linking(app_t *app)
+{
+	static const ret_t ret_symbols = {
+		.lnt = LINT_WARN,
+		.msg = "binary links to non-whitelisted shared libraries: %s",
+		.uri = LV2_CORE__binary,
+		.dsc = "The ideal plugin dynamically links maximally to libc, libm, librt, "
+			"libstdc++, libgcc_s."
+	},
+	ret_libstdcpp = {
+		.lnt = LINT_WARN,
+		.msg = "binary links to C++ libraries: %s",
+		.uri = LV2_CORE__binary,
+		.dsc = "C++ ABI incompatibilities between host and plugin are to be expected."
+	};
+
+	const ret_t *ret = NULL;
+
+	static const char *whitelist [] = {
+		"libc",
+		"libm",
+		"librt",
+		"libstdc++",
+		"libgcc_s"
+	};
+	const unsigned n_whitelist = sizeof(whitelist) / sizeof(const char *);
+
+	static const char *graylist [] = {
+		"libstdc++",
+		"libgcc_s"
+	};
+	const unsigned n_graylist = sizeof(graylist) / sizeof(const char *);
+
+	const LilvNode* node = lilv_plugin_get_library_uri(app->plugin);
+	if(node && lilv_node_is_uri(node))
+	{
+		const char *uri = lilv_node_as_uri(node);
+		if(uri)
+		{
+			char *path = lilv_file_uri_parse(uri, NULL);
+			if(path)
+			{
+				char *libraries = NULL;
+				if(!test_shared_libraries(path, whitelist, n_whitelist, NULL, 0, &libraries))
+				{
+					*app->urn = libraries;
+					ret = &ret_symbols;
+				}
+				else if(!test_shared_libraries(path, NULL, 0, graylist, n_graylist, &libraries))
+				{
+					*app->urn = libraries;
+					ret = &ret_libstdcpp;
+				}
+				else if(libraries)
+				{
+					free(libraries);
+				}
+
+				lilv_free(path);
+			}
+		}
+	}
+
+	return ret;
+}
+
+static const ret_t *
+_test_dependencies(app_t *app)
+{
+	static const ret_t ret_unresolved = {
+		.lnt = LINT_WARN,
+		.msg = "binary links to shared libraries which cannot be found: %s",
+		.uri = LV2_CORE__binary,
+		.dsc = "Hosts will fail to load the plugin binary. Ship the libraries "
+			"and point DT_RUNPATH to them via $ORIGIN or link them statically."
+	},
+	ret_toolkit = {
+		.lnt = LINT_WARN,
+		.msg = "binary transitively links to GUI toolkit libraries: %s",
+		.uri = LV2_CORE__binary,
+		.dsc = "The DSP binary should not depend on any GUI toolkit, as loading "
+			"those costs considerable time and memory per plugin. Move GUI code "
+			"into a separate UI binary."
+	},
+	ret_dependencies [] = {
+		{
+			.lnt = LINT_NOTE,
+			.msg = "binary dependencies: %s",
+			.uri = LV2_CORE__binary,
+			.dsc = "Shared libraries loaded along with the plugin binary."
+		},
+		{
+			.lnt = LINT_WARN,
+			.msg = "binary dependencies exceed limit: %s",
+			.uri = LV2_CORE__binary,
+			.dsc = "Every shared library needs to be found, mapped and relocated "
+				"at load time. Link only what the DSP code really needs."
+		}
+	};
+
+	static const char *blacklist [] = {
+		"libgtk",
+		"libgdk",
+		"libQt",
+		"libX11",
+		"libxcb",
+		"libGL",
+		"libwx_",
+		"libfltk",
+		"libSDL"
+	};
+	const unsigned n_blacklist = sizeof(blacklist) / sizeof(const char *);
+
+	const ret_t *ret = NULL;
+
+	const LilvNode* node = lilv_plugin_get_library_uri(app->plugin);
+	if(node && lilv_node_is_uri(node))
+	{
+		const char *uri = lilv_node_as_uri(node);
+		if(uri)
+		{
+			char *path = lilv_file_uri_parse(uri, NULL);
+			if(path)
+			{
+				closure_t closure;
+				test_dependencies(app, path, blacklist, n_blacklist, &closure);
+
+				if(closure.unresolved)
+				{
+					*app->urn = closure.unresolved;
+					closure.unresolved = NULL;
+					ret = &ret_unresolved;
+				}
+				else if(closure.blacklisted)
+				{
+					*app->urn = closure.blacklisted;
+					closure.blacklisted = NULL;
+					ret = &ret_toolkit;
+				}
+				else
+				{
+					const double size_kib = closure.size / 1024.0;
+
+					lint_t lnt = lv2lint_limit(app, LIMIT_LIBRARIES, closure.n_libraries);
+					lnt |= lv2lint_limit(app, LIMIT_LIBRARY_SIZE, size_kib);
+
+					if(asprintf(app->urn, "%u shared libraries, %.0f KiB mapped",
+						closure.n_libraries, size_kib) == -1)
+					{
+						*app->urn = NULL;
+					}
+
+					ret = lv2lint_grade(app, lnt, ret_dependencies);
+				}
+
+				free(closure.unresolved);
+				free(closure.blacklisted);
+				lilv_free(path);
+			}
+		}
+	}
+
+	return ret;
+}
+
+static const ret_t *
+_test_load_cost(app_t *app)
+{
+	static const ret_t ret_text_relocations = {
+		.lnt = LINT_WARN,
+		.msg = "binary contains text relocations",
+		.uri = LV2_CORE__binary,
+		.dsc = "Text relocations make the dynamic linker patch and thus copy "
+			"code pages at load time and are denied on hardened systems. "
+			"You may well have forgotten to compile with -fPIC."
+	},
+	ret_load_cost [] = {
+		{
+			.lnt = LINT_NOTE,
+			.msg = "dlopen cost: %s",
+			.uri = LV2_CORE__binary,
+			.dsc = "Estimated cost for the dynamic linker to load the plugin binary."
+		},
+		{
+			.lnt = LINT_WARN,
+			.msg = "dlopen cost exceeds limit: %s",
+			.uri = LV2_CORE__binary,
+			.dsc = "Hosts scanning and loading hundreds of plugins are slowed down "
+				"considerably. Hide internal symbols (-fvisibility=hidden), bind "
+				"references locally (-Wl,-Bsymbolic), link with --hash-style=gnu "
+				"and avoid static constructors and global-dynamic TLS."
+		}
+	};
+
+	const ret_t *ret = NULL;
+
+	const LilvNode* node = lilv_plugin_get_library_uri(app->plugin);
+	if(node && lilv_node_is_uri(node))
+	{
+		const char *uri = lilv_node_as_uri(node);
+		if(uri)
+		{
+			char *path = lilv_file_uri_parse(uri, NULL);
+			if(path)
+			{
+				load_cost_t cost;
+				if(!test_load_cost(path, &cost))
+				{
+					ret = &ret_text_relocations;
+				}
+				else
+				{
+					const lint_t lnt = lv2lint_limit(app, LIMIT_LOAD_COST, cost.score);
+
+					if(asprintf(app->urn, "%.0f (%u relative, %u symbolic, %u interposable, "
+						"%u ifunc relocations, %u constructors, %u dynamic TLS, %s%s)",
+						cost.score, cost.relative, cost.symbolic,
+						cost.symbolic_binding ? 0 : cost.interposable, cost.irelative,
+						cost.constructors, cost.tls_dynamic,
+						cost.gnu_hash ? "GNU hash" : "SysV hash",
+						cost.symbolic_binding ? ", symbolic" : "") == -1)
+					{
+						*app->urn = NULL;
+					}
+
+					ret = lv2lint_grade(app, lnt, ret_load_cost);
+				}
+
+				lilv_free(path);
+			}
+		}
+	}
+
+	return ret;
+}
+
+static const ret_t *
+_test_lazy_binding(app_t *app)
+{
+	static const ret_t ret_lazy_binding = {
+		.lnt = LINT_WARN,
+		.msg = "binary binds symbols lazily: %s",
+		.uri = LV2_CORE__hardRTCapable,
+		.dsc = "Without immediate binding, the first call of each imported "
+			"function resolves its PLT entry in the dynamic linker, possibly on "
+			"the audio thread, taking locks and faulting in pages. Link with "
+			"-Wl,-z,now."
+	};
+
+	const ret_t *ret = NULL;
+
+	const LilvNode* node = lilv_plugin_get_library_uri(app->plugin);
+	if(node && lilv_node_is_uri(node))
+	{
+		const char *uri = lilv_node_as_uri(node);
+		if(uri)
+		{
+			char *path = lilv_file_uri_parse(uri, NULL);
+			if(path)
+			{
+				load_cost_t cost;
+				test_load_cost(path, &cost);
+
+				if(!cost.bind_now && cost.jump_slots)
+				{
+					if(asprintf(app->urn, "%u PLT entries resolved on first call",
+						cost.jump_slots) == -1)
+					{
+						*app->urn = NULL;
+					}
+
+					ret = &ret_lazy_binding;
+				}
+
+				lilv_free(path);
+			}
+		}
+	}
+
+	return ret;
+}
+
+#	ifdef ENABLE_CAPSTONE
+static const isa_t *
+_plugin_isa(app_t *app)
+{
+	// disassemble lazily, only once per plugin
+	if(app->isa)
+	{
+		return app->isa;
+	}
+
+	const LilvNode* node = lilv_plugin_get_library_uri(app->plugin);
+	if(node && lilv_node_is_uri(node))
+	{
+		const char *uri = lilv_node_as_uri(node);
+		if(uri)
+		{
+			char *path = lilv_file_uri_parse(uri, NULL);
+			if(path)
+			{
+				app->isa = calloc(1, sizeof(isa_t));
+				if(app->isa)
+				{
+					test_instruction_set(path, app->isa);
+				}
+
+				lilv_free(path);
+			}
+		}
+	}
+
+	return app->isa;
+}
+
+static const ret_t *
+_test_instruction_set(app_t *app)
+{
+	static const ret_t ret_isa = {
+		.lnt = LINT_NOTE,
+		.msg = "binary uses instructions up to %s",
+		.uri = LV2_CORE__binary,
+		.dsc = NULL
+	},
+	ret_avx512 = {
+		.lnt = LINT_NOTE,
+		.msg = "binary uses AVX-512 instructions",
+		.uri = LV2_CORE__binary,
+		.dsc = "Most CPUs lack AVX-512. This is fine if its use is dispatched at "
+			"run-time depending on CPU features, otherwise the plugin crashes."
+	},
+	ret_avx512_undispatched = {
+		.lnt = LINT_WARN,
+		.msg = "binary uses AVX-512 instructions without querying CPU features",
+		.uri = LV2_CORE__binary,
+		.dsc = "Most CPUs lack AVX-512 and the binary never executes cpuid, "
+			"neither directly nor via __builtin_cpu_supports or target_clones, "
+			"so the plugin crashes with an illegal instruction on them. "
+			"Dispatch at run-time or build for a baseline like x86-64-v3."
+	},
+	ret_x87 = {
+		.lnt = LINT_WARN,
+		.msg = "binary uses x87 floating-point instructions only",
+		.uri = LV2_CORE__binary,
+		.dsc = "x87 floating-point math is slow and suffers from denormals, "
+			"build with SSE2 support (e.g. -mfpmath=sse -msse2)."
+	};
+
+	const ret_t *ret = NULL;
+
+	const isa_t *isa = _plugin_isa(app);
+	if(!isa)
+	{
+		return NULL;
+	}
+
+	if(isa->avx512)
+	{
+		ret = isa->cpuid
+			? &ret_avx512
+			: &ret_avx512_undispatched;
+	}
+	else if(isa->x87_only)
+	{
+		ret = &ret_x87;
+	}
+	else if(isa->highest)
+	{
+		*app->urn = strdup(isa->highest);
+		ret = &ret_isa;
+	}
+
+	return ret;
+}
+
+static const ret_t *
+_test_fast_math(app_t *app)
 {
-	static const ret_t ret_symbols = {
-		.lnt = LINT_FAIL,
-		.msg = "binary exports superfluous globally visible symbols: %s",
+	static const ret_t ret_fast_math = {
+		.lnt = LINT_WARN,
+		.msg = "binary alters floating-point environment at load time",
 		.uri = LV2_CORE__binary,
-		.dsc = "Plugin binaries must not export any globally visible symbols "
-			 "but lv2_descriptor. You may well have forgotten to compile "
-			 "with -fvisibility=hidden."
+		.dsc = "Setting flush-to-zero or denormals-are-zero modes from a "
+			"constructor (e.g. crtfastmath.o linked in via -ffast-math) changes "
+			"numerics process-wide for the host and every other plugin, "
+			"link with -fno-fast-math or set the flags locally in run()."
 	};
 
 	const ret_t *ret = NULL;
 
-	const LilvNode* node = lilv_plugin_get_library_uri(app->plugin);
-	if(node && lilv_node_is_uri(node))
+	const isa_t *isa = _plugin_isa(app);
+	if(isa && isa->fast_math)
 	{
-		const char *uri = lilv_node_as_uri(node);
-		if(uri)
-		{
-			char *path = lilv_file_uri_parse(uri, NULL);
-			if(path)
-			{
-				char *symbols = NULL;
-				if(!test_visibility(path, "lv2_descriptor", &symbols))
-				{
-					*app->urn = symbols;
-					ret = &ret_symbols;
-				}
-				else if(symbols)
-				{
-					free(symbols);
-				}
-
-				lilv_free(path);
-			}
-		}
+		ret = &ret_fast_math;
 	}
 
 	return ret;
 }
 
 static const ret_t *
-_test_linking(app_t *app)
+_test_realtime_calls(app_t *app)
 {
-	static const ret_t ret_symbols = {
+	static const ret_t ret_calls = {
 		.lnt = LINT_WARN,
-		.msg = "binary links to non-whitelisted shared libraries: %s",
-		.uri = LV2_CORE__binary,
-		.dsc = "The ideal plugin dynamically links maximally to libc, libm, librt, "
-			"libstdc++, libgcc_s."
+		.msg = "run() may call non-realtime-safe functions: %s",
+		.uri = LV2_CORE__hardRTCapable,
+		.dsc = "Memory allocation, locking, file and console I/O are not "
+			"realtime-safe and must not be called from the audio thread. "
+			"Indirect calls are not followed by this test."
 	},
-	ret_libstdcpp = {
-		.lnt = LINT_WARN,
-		.msg = "binary links to C++ libraries: %s",
-		.uri = LV2_CORE__binary,
-		.dsc = "C++ ABI incompatibilities between host and plugin are to be expected."
+	ret_calls_hard_rt = {
+		.lnt = LINT_FAIL,
+		.msg = "run() of hard RT capable plugin may call non-realtime-safe functions: %s",
+		.uri = LV2_CORE__hardRTCapable,
+		.dsc = "Memory allocation, locking, file and console I/O are not "
+			"realtime-safe and must not be called from the audio thread. "
+			"Indirect calls are not followed by this test."
+	};
+
+	static const char *blacklist [] = {
+		// memory allocation
+		"malloc",
+		"calloc",
+		"realloc",
+		"free",
+		"memalign",
+		"posix_memalign",
+		"aligned_alloc",
+		"valloc",
+		"_Znw", // operator new
+		"_Zna", // operator new[]
+		"_Zdl", // operator delete
+		"_Zda", // operator delete[]
+		"__cxa_allocate_exception",
+		"__cxa_throw",
+		"mmap",
+		"munmap",
+		"mlock",
+		// locking
+		"pthread_mutex_lock",
+		"pthread_rwlock_rdlock",
+		"pthread_rwlock_wrlock",
+		"pthread_cond_wait",
+		"pthread_cond_timedwait",
+		"pthread_join",
+		"pthread_create",
+		"sem_wait",
+		"sem_timedwait",
+		// console and file I/O
+		"printf",
+		"fprintf",
+		"vprintf",
+		"vfprintf",
+		"__printf_chk",
+		"__fprintf_chk",
+		"__vprintf_chk",
+		"__vfprintf_chk",
+		"puts",
+		"fputs",
+		"fputc",
+		"putchar",
+		"fwrite",
+		"fread",
+		"fflush",
+		"fopen",
+		"fclose",
+		"open",
+		"close",
+		"read",
+		"write",
+		"_ZNSo", // std::ostream
+		"_ZStlsISt11char_traitsIcEERSt13basic_ostreamIcT_ES5_PKc", // std::operator<<
+		// sleeping and process control
+		"sleep",
+		"usleep",
+		"nanosleep",
+		"system",
+		"fork",
+		"dlopen",
+		"dlclose"
 	};
+	const unsigned n_blacklist = sizeof(blacklist) / sizeof(const char *);
 
 	const ret_t *ret = NULL;
 
-	static const char *whitelist [] = {
-		"libc",
-		"libm",
-		"librt",
-		"libstdc++",
-		"libgcc_s"
-	};
-	const unsigned n_whitelist = sizeof(whitelist) / sizeof(const char *);
+	if(!app->instance)
+	{
+		return NULL;
+	}
 
-	static const char *graylist [] = {
-		"libstdc++",
-		"libgcc_s"
-	};
-	const unsigned n_graylist = sizeof(graylist) / sizeof(const char *);
+	const LV2_Descriptor *descriptor = lilv_instance_get_descriptor(app->instance);
+	uintptr_t roots [3];
+	unsigned n_roots = 0;
 
-	const LilvNode* node = lilv_plugin_get_library_uri(app->plugin);
-	if(node && lilv_node_is_uri(node))
+	roots[n_roots++] = (uintptr_t)descriptor->run;
+
+	// worker responses and end_run are called from the audio thread, too
+	if(app->work_iface)
 	{
-		const char *uri = lilv_node_as_uri(node);
-		if(uri)
+		if(app->work_iface->work_response)
 		{
-			char *path = lilv_file_uri_parse(uri, NULL);
-			if(path)
-			{
-				char *libraries = NULL;
-				if(!test_shared_libraries(path, whitelist, n_whitelist, NULL, 0, &libraries))
-				{
-					*app->urn = libraries;
-					ret = &ret_symbols;
-				}
-				else if(!test_shared_libraries(path, NULL, 0, graylist, n_graylist, &libraries))
-				{
-					*app->urn = libraries;
-					ret = &ret_libstdcpp;
-				}
-				else if(libraries)
-				{
-					free(libraries);
-				}
-
-				lilv_free(path);
-			}
+			roots[n_roots++] = (uintptr_t)app->work_iface->work_response;
+		}
+		if(app->work_iface->end_run)
+		{
+			roots[n_roots++] = (uintptr_t)app->work_iface->end_run;
 		}
 	}
 
+	char *symbols = NULL;
+	if(!test_realtime_calls(roots, n_roots, blacklist, n_blacklist, &symbols))
+	{
+		const bool is_hard_rt_capable = lilv_plugin_has_feature(app->plugin,
+			app->uris.lv2_hardRTCapable);
+
+		*app->urn = symbols;
+		ret = is_hard_rt_capable ? &ret_calls_hard_rt : &ret_calls;
+	}
+	else if(symbols)
+	{
+		free(symbols);
+	}
+
 	return ret;
 }
+#	endif
 #endif
 
 static const ret_t *
@@ -1291,6 +5112,98 @@ _test_idisp(app_t *app)
 	return ret;
 }
 
+#define CALLBACK_BLOCKS 16
+
+static const char *callback_names [CALLBACK_MAX] = {
+	[CALLBACK_MAP] = "urid:map",
+	[CALLBACK_LOG] = "log"
+};
+
+static const ret_t *
+_test_audio_thread(app_t *app)
+{
+	static const ret_t ret_audio_thread [CALLBACK_MAX] = {
+		[CALLBACK_MAP] = {
+			.lnt = LINT_WARN,
+			.msg = "maps URIs from the audio thread: %s",
+			.uri = LV2_URID__map,
+			.dsc = "Mapping URIs means hashing, locking and possibly allocating in "
+				"the host. Map all needed URIDs in instantiate()."
+		},
+		[CALLBACK_LOG] = {
+			.lnt = LINT_WARN,
+			.msg = "logs from the audio thread: %s",
+			.uri = LV2_LOG__log,
+			.dsc = "Logging means formatting and taking stdio locks in the host. "
+				"Defer messages to the worker or pass them to the UI."
+		}
+	};
+
+	const ret_t *ret = NULL;
+
+	run_t *run = lv2lint_run_get(app);
+	if(!run)
+	{
+		return lv2lint_run_skipped(app);
+	}
+
+	// make sure run() got some input, even if no other test ran it
+	uint32_t state = RUN_SEED;
+	for(unsigned b = 0; b < CALLBACK_BLOCKS; b++)
+	{
+		for(unsigned i = 0; i < run->n_ports; i++)
+		{
+			run_port_t *port = &run->ports[i];
+
+			if( (port->type == RUN_PORT_AUDIO) && port->input)
+			{
+				lv2lint_run_signal(port, RUN_SIGNAL_NOISE, run->block_length, &state);
+			}
+			else if( (port->type == RUN_PORT_ATOM) && port->input
+				&& lilv_port_supports_event(app->plugin, port->port, app->uris.midi_MidiEvent) )
+			{
+				_sequence_fill(run, port, b);
+			}
+		}
+
+		lv2lint_run(run, run->block_length);
+	}
+
+	char *calls = NULL;
+
+	for(unsigned c = 0; c < CALLBACK_MAX; c++)
+	{
+		const callback_stats_t *stats = &app->callbacks[c];
+		const unsigned n = atomic_load_explicit(&stats->calls[PHASE_RUN],
+			memory_order_relaxed);
+		char *tmp = NULL;
+
+		if(!n)
+		{
+			continue;
+		}
+
+		if(!ret)
+		{
+			ret = &ret_audio_thread[c];
+		}
+
+		if(asprintf(&tmp, "%s%s%s %u times from run() on thread #%u, first '%s'",
+			calls ? calls : "", calls ? ", " : "", callback_names[c], n,
+			stats->thread, stats->what) == -1)
+		{
+			tmp = NULL;
+		}
+
+		free(calls);
+		calls = tmp;
+	}
+
+	*app->urn = calls;
+
+	return ret;
+}
+
 static const ret_t *
 _test_hard_rt_capable(app_t *app)
 {
@@ -1337,6 +5250,107 @@ _test_in_place_broken(app_t *app)
 	return ret;
 }
 
+#define IDLE_BLOCKS 64 // measured per signal, the cheapest one counts
+#define IDLE_SETTLE 2 // s of silence to let tails decay
+
+static uint64_t
+_idle_measure(run_t *run, run_signal_t signal, unsigned n_blocks,
+	uint32_t *state)
+{
+	uint64_t min = UINT64_MAX;
+
+	for(unsigned b = 0; b < n_blocks; b++)
+	{
+		for(unsigned i = 0; i < run->n_ports; i++)
+		{
+			run_port_t *port = &run->ports[i];
+
+			if( ( (port->type == RUN_PORT_AUDIO) || (port->type == RUN_PORT_CV) )
+				&& port->input)
+			{
+				lv2lint_run_signal(port, signal, run->block_length, state);
+			}
+		}
+
+		const uint64_t ns = lv2lint_run(run, run->block_length);
+
+		if(ns < min)
+		{
+			min = ns;
+		}
+	}
+
+	return min;
+}
+
+static const ret_t *
+_test_idle_cost(app_t *app)
+{
+	static const ret_t ret_idle_cost [] = {
+		{
+			.lnt = LINT_NOTE,
+			.msg = "idle cost: %s",
+			.uri = LV2_CORE__isLive,
+			.dsc = "Cost of run() on silence, once tails have decayed, compared to "
+				"its cost on noise."
+		},
+		{
+			.lnt = LINT_WARN,
+			.msg = "idle cost exceeds limit: %s",
+			.uri = LV2_CORE__isLive,
+			.dsc = "run() costs about as much on silence as on signal. Sessions "
+				"with many idle tracks are dominated by such plugins. Detect "
+				"silent input and decayed state and skip processing, and flush "
+				"denormals in feedback paths."
+		}
+	};
+
+	const ret_t *ret = NULL;
+
+	if(!app->perf)
+	{
+		return NULL;
+	}
+
+	run_t *run = lv2lint_run_get(app);
+	if(!run)
+	{
+		return lv2lint_run_skipped(app);
+	}
+
+	uint32_t state = RUN_SEED;
+	const unsigned n_settle = IDLE_SETTLE * app->sample_rate / run->block_length;
+
+	const uint64_t active = _idle_measure(run, RUN_SIGNAL_NOISE, IDLE_BLOCKS,
+		&state);
+	_idle_measure(run, RUN_SIGNAL_SILENCE, n_settle, &state);
+	const uint64_t idle = _idle_measure(run, RUN_SIGNAL_SILENCE, IDLE_BLOCKS,
+		&state);
+
+	if(!active || (active == UINT64_MAX) )
+	{
+		return NULL;
+	}
+
+	const double ratio = 100.0 * idle / active;
+	const double period_ns = run->block_length * 1e9 / app->sample_rate;
+
+	// idle cost does not matter for plugins next to free anyway
+	const lint_t lnt = (active > 0.01 * period_ns)
+		? lv2lint_limit(app, LIMIT_IDLE_COST, ratio)
+		: LINT_NOTE;
+
+	if(asprintf(app->urn, "%.1f us on silence vs. %.1f us on noise (%.0f%%)",
+		idle * 1e-3, active * 1e-3, ratio) == -1)
+	{
+		*app->urn = NULL;
+	}
+
+	ret = lv2lint_grade(app, lnt, ret_idle_cost);
+
+	return ret;
+}
+
 static const ret_t *
 _test_is_live(app_t *app)
 {
@@ -1510,12 +5524,147 @@ _test_patch(app_t *app)
 	return ret;
 }
 
+#define LOG_SHOWN 16
+
+static const char *phase_names [PHASE_MAX] = {
+	[PHASE_OTHER] = "other",
+	[PHASE_INSTANTIATE] = "instantiate",
+	[PHASE_ACTIVATE] = "activate",
+	[PHASE_RUN] = "run",
+	[PHASE_WORKER] = "worker"
+};
+
+static const ret_t *
+_test_log(app_t *app)
+{
+	static const ret_t ret_log [] = {
+		{
+			.lnt = LINT_NOTE,
+			.msg = "log messages: %s",
+			.uri = LV2_LOG__log,
+			.dsc = "Messages the plugin logged while being tested."
+		},
+		{
+			.lnt = LINT_WARN,
+			.msg = "log rate from run() exceeds limit: %s",
+			.uri = LV2_LOG__log,
+			.dsc = "Messages logged from run() at this rate flood the host's log "
+				"and the user's terminal. Log state changes once, not per block."
+		}
+	};
+	static const ret_t ret_log_severe = {
+		.lnt = LINT_WARN,
+		.msg = "errors or warnings logged: %s",
+		.uri = LV2_LOG__Error,
+		.dsc = "The plugin logged errors or warnings while being tested with a "
+			"regular host setup. Run with -d to see them as they are logged."
+	};
+
+	const ret_t *ret = NULL;
+	log_stats_t stats;
+
+	log_msg_t *msgs = lv2lint_log_get(&stats);
+	if(!stats.n_msgs && !stats.n_dropped)
+	{
+		free(msgs);
+		return NULL;
+	}
+
+	// rate over the span run() has been logging in, at least a second
+	const double span = (stats.run_last - stats.run_first) * 1e-9;
+	const double rate = stats.n_run / (span > 1.0 ? span : 1.0);
+	const lint_t lnt = stats.n_run
+		? lv2lint_limit(app, LIMIT_LOG_RATE, rate)
+		: LINT_NOTE;
+
+	char *txt = NULL;
+
+	if(asprintf(&txt, "%u messages (%u errors or warnings, %u from run() at "
+		"%.1f/s, %u dropped)", stats.n_msgs + stats.n_dropped, stats.n_severe,
+		stats.n_run, rate, stats.n_dropped) == -1)
+	{
+		txt = NULL;
+	}
+
+	const unsigned n_shown = (stats.n_kept < LOG_SHOWN) ? stats.n_kept : LOG_SHOWN;
+
+	for(unsigned i = 0; txt && msgs && (i < n_shown); i++)
+	{
+		const log_msg_t *msg = &msgs[i];
+		const char *type = msg->type && app->unmap
+			? app->unmap->unmap(app->unmap->handle, msg->type)
+			: NULL;
+		const char *frag = type ? strrchr(type, '#') : NULL;
+		char *tmp = NULL;
+
+		if(asprintf(&tmp, "%s\n                [+%.3f ms thread #%u %s %s] %s",
+			txt, (msg->ns - msgs[0].ns) * 1e-6, msg->thread,
+			phase_names[msg->phase], frag ? frag + 1 : (type ? type : "?"),
+			msg->txt) == -1)
+		{
+			tmp = NULL;
+		}
+
+		free(txt);
+		txt = tmp;
+	}
+
+	if(txt && (stats.n_kept > n_shown) )
+	{
+		char *tmp = NULL;
+
+		if(asprintf(&tmp, "%s\n                [%u more]", txt,
+			stats.n_msgs + stats.n_dropped - n_shown) == -1)
+		{
+			tmp = NULL;
+		}
+
+		free(txt);
+		txt = tmp;
+	}
+
+	free(msgs);
+
+	*app->urn = txt;
+	ret = ( (lnt == LINT_NOTE) && stats.n_severe )
+		? &ret_log_severe
+		: lv2lint_grade(app, lnt, ret_log);
+
+	return ret;
+}
+
+// graded after ports and parameters, to include what was logged meanwhile
+static const test_t test_log = {"Log", _test_log};
+
 static const test_t tests [] = {
 	{"Instantiation",   _test_instantiation},
+	{"Load Time",       _test_load_time},
+	{"Footprint",       _test_footprint},
+	{"First Run",       _test_first_run},
+	{"Port Bounds",     _test_port_bounds},
+	{"Sequence",        _test_sequence},
+	{"HW Counters",     _test_counters},
+	{"Cache",           _test_cache},
+	{"WCET",            _test_wcet},
+	{"Scaling",         _test_scaling},
+	{"Deadline",        _test_deadline},
+#if defined(__linux__)
+	{"Parallel Load",   _test_parallel_load},
+#endif
+	{"Latency",         _test_latency},
 #ifdef ENABLE_ELF_TESTS
 	{"Symbols",         _test_symbols},
 	{"Linking",         _test_linking},
+	{"Dependencies",    _test_dependencies},
+	{"Load Cost",       _test_load_cost},
+	{"Lazy Binding",    _test_lazy_binding},
+#	ifdef ENABLE_CAPSTONE
+	{"Instruction Set", _test_instruction_set},
+	{"Fast Math",       _test_fast_math},
+	{"Realtime Calls",  _test_realtime_calls},
+#	endif
 #endif
+	{"Profile",         _test_profile}, // after Symbols, to reuse its symbol tables
 	{"Verification",    _test_verification},
 	{"Name",            _test_name},
 	{"License",         _test_license},
@@ -1537,11 +5686,19 @@ static const test_t tests [] = {
 	{"Shortdesc",       _test_shortdesc},
 	{"Inline Display",  _test_idisp},
 	{"Hard RT Capable", _test_hard_rt_capable},
+	{"Audio Thread",    _test_audio_thread},
 	{"In Place Broken", _test_in_place_broken},
+	{"In Place",        _test_in_place},
 	{"Is Live",         _test_is_live},
+	{"Idle Cost",       _test_idle_cost},
 	//{"Bounded Block",   _test_bounded_block_length}, //TODO check for opts:opt
 	{"Fixed Block",     _test_fixed_block_length},
 	{"PowerOf2 Block",  _test_power_of_2_block_length},
+#if defined(__linux__)
+	{"Alignment",       _test_alignment},
+#endif
+	{"Block Split",     _test_block_split},
+	{"Fingerprint",     _test_fingerprint},
 #ifdef ENABLE_ONLINE_TESTS
 	{"Plugin URL",      _test_plugin_url},
 #endif
@@ -1568,9 +5725,15 @@ test_plugin(app_t *app)
 		res_t *res = &rets[i];
 
 		res->urn = NULL;
+		res->lnt = 0;
 		app->urn = &res->urn;
+		app->lnt = &res->lnt;
 		res->ret = test->cb(app);
-		if(res->ret && (res->ret->lnt & app->show) )
+		if(!res->ret)
+			res->lnt = 0;
+		else if(!res->lnt) // not graded by the test
+			res->lnt = res->ret->lnt;
+		if(res->lnt & app->show)
 			msg = true;
 	}
 
@@ -1654,6 +5817,47 @@ test_plugin(app_t *app)
 		app->readables = NULL;
 	}
 
+	{
+		res_t res = { .urn = NULL, .lnt = 0 };
+
+		app->urn = &res.urn;
+		app->lnt = &res.lnt;
+		res.ret = test_log.cb(app);
+		if(!res.ret)
+			res.lnt = 0;
+		else if(!res.lnt) // not graded by the test
+			res.lnt = res.ret->lnt;
+
+		if( (res.lnt & app->show) || show_passes)
+		{
+			lv2lint_printf(app, "  %s(log)%s\n",
+				colors[app->atty][ANSI_COLOR_BOLD],
+				colors[app->atty][ANSI_COLOR_RESET]);
+
+			lv2lint_report(app, &test_log, &res, show_passes, &flag);
+		}
+		else
+		{
+			free(res.urn);
+		}
+	}
+
+	lv2lint_run_free(app->run);
+	app->run = NULL;
+
+#ifdef ENABLE_ELF_TESTS
+	if(app->symtab)
+	{
+		free_symtab(app->symtab);
+		free(app->symtab);
+		app->symtab = NULL;
+	}
+#	ifdef ENABLE_CAPSTONE
+	free(app->isa);
+	app->isa = NULL;
+#	endif
+#endif
+
 	LilvUIs *uis = lilv_plugin_get_uis(app->plugin);
 	if(uis)
 	{
@@ -1687,3 +5891,27 @@ test_plugin(app_t *app)
 
 	return flag;
 }
+
+bool
+helper_plugin(app_t *app)
+{
+	if(!app->instance)
+	{
+		return false;
+	}
+
+#if defined(__linux__)
+	switch(app->helper)
+	{
+		case HELPER_LOAD:
+			return _load_helper(app);
+		case HELPER_ALIGN:
+			return _align_helper(app);
+		case HELPER_NONE:
+		case HELPER_MAX:
+			break;
+	}
+#endif
+
+	return false;
+}
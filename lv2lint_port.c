@@ -15,6 +15,7 @@
  * http://www.perlfoundation.org/artistic_license_2_0.
  */
 
+#include <stdio.h>
 #include <math.h>
 
 #include <lv2lint.h>
@@ -538,6 +539,198 @@ _test_unit(app_t *app)
 	return ret;
 }
 
+#define SWEEP_STEPS  16 // settings between minimum and maximum
+#define SWEEP_TRIALS 3 // repetitions per setting, the cheapest one counts
+#define SWEEP_SETTLE 2 // blocks to settle at default between step changes
+#define SWEEP_FLOOR  0.01 // of block period, below which spikes are timer noise
+
+static uint64_t
+_sweep_block(run_t *run, run_port_t *port, float value, uint32_t *state)
+{
+	*(float *)port->buf = value;
+
+	// measure on signal, as silence may take shortcuts
+	for(unsigned i = 0; i < run->n_ports; i++)
+	{
+		run_port_t *input = &run->ports[i];
+
+		if( ( (input->type == RUN_PORT_AUDIO) || (input->type == RUN_PORT_CV) )
+			&& input->input)
+		{
+			lv2lint_run_signal(input, RUN_SIGNAL_NOISE, run->block_length, state);
+		}
+	}
+
+	return lv2lint_run(run, run->block_length);
+}
+
+static float
+_sweep_value(app_t *app, const run_port_t *port, unsigned step, unsigned steps)
+{
+	const float value = port->min + (port->max - port->min) * step / (steps - 1);
+
+	if(  lilv_port_has_property(app->plugin, port->port, app->uris.lv2_integer)
+		|| lilv_port_has_property(app->plugin, port->port, app->uris.lv2_toggled) )
+	{
+		return roundf(value);
+	}
+
+	return value;
+}
+
+static const ret_t *
+_test_sweep(app_t *app)
+{
+	static const ret_t ret_sweep [] = {
+		{
+			.lnt = LINT_NOTE,
+			.msg = "control sweep: %s",
+			.uri = LV2_CORE__ControlPort,
+			.dsc = "run() cost while stepping and ramping this control from its "
+				"minimum to its maximum, relative to the cost at its default."
+		},
+		{
+			.lnt = LINT_WARN,
+			.msg = "control sweep exceeds limit: %s",
+			.uri = LV2_CORE__ControlPort,
+			.dsc = "Moving this control causes load spikes. Avoid recomputing "
+				"coefficients with expensive functions like pow or exp on every "
+				"block, e.g. by only doing so on actual changes, by smoothing "
+				"parameters or by using lookup tables."
+		}
+	};
+
+	const ret_t *ret = NULL;
+
+	if(!app->perf)
+	{
+		return NULL;
+	}
+
+	run_t *run = lv2lint_run_get(app);
+	if(!run)
+	{
+		return lv2lint_run_skipped(app);
+	}
+
+	run_port_t *port = &run->ports[lilv_port_get_index(app->plugin, app->port)];
+	if( (port->type != RUN_PORT_CONTROL) || !port->input
+		|| !(port->max > port->min) )
+	{
+		return NULL;
+	}
+
+	uint32_t state = RUN_SEED;
+
+	// baseline at default
+	uint64_t ns_dflt = UINT64_MAX;
+	for(unsigned i = 0; i < SWEEP_TRIALS * SWEEP_SETTLE; i++)
+	{
+		const uint64_t ns = _sweep_block(run, port, port->dflt, &state);
+
+		if(ns < ns_dflt)
+		{
+			ns_dflt = ns;
+		}
+	}
+
+	// step changes from default to each setting
+	uint64_t ns_step [SWEEP_STEPS];
+	for(unsigned s = 0; s < SWEEP_STEPS; s++)
+	{
+		const float value = _sweep_value(app, port, s, SWEEP_STEPS);
+
+		ns_step[s] = UINT64_MAX;
+		for(unsigned t = 0; t < SWEEP_TRIALS; t++)
+		{
+			const uint64_t ns = _sweep_block(run, port, value, &state);
+
+			if(ns < ns_step[s])
+			{
+				ns_step[s] = ns;
+			}
+
+			for(unsigned i = 0; i < SWEEP_SETTLE; i++)
+			{
+				_sweep_block(run, port, port->dflt, &state);
+			}
+		}
+	}
+
+	// per-block ramps up and down the whole range
+	uint64_t ns_ramp = UINT64_MAX;
+	for(unsigned t = 0; t < SWEEP_TRIALS; t++)
+	{
+		uint64_t ns = 0;
+
+		for(unsigned s = 0; s < 2*SWEEP_STEPS; s++)
+		{
+			const unsigned step = (s < SWEEP_STEPS)
+				? s
+				: 2*SWEEP_STEPS - 1 - s;
+
+			ns += _sweep_block(run, port, _sweep_value(app, port, step, SWEEP_STEPS),
+				&state);
+		}
+
+		if(ns < ns_ramp)
+		{
+			ns_ramp = ns;
+		}
+	}
+
+	_sweep_block(run, port, port->dflt, &state);
+
+	unsigned worst = 0;
+	double mean = 0.0;
+	for(unsigned s = 0; s < SWEEP_STEPS; s++)
+	{
+		if(ns_step[s] > ns_step[worst])
+		{
+			worst = s;
+		}
+
+		mean += ns_step[s];
+	}
+	mean /= SWEEP_STEPS;
+
+	double variance = 0.0;
+	for(unsigned s = 0; s < SWEEP_STEPS; s++)
+	{
+		const double diff = ns_step[s] - mean;
+
+		variance += diff*diff;
+	}
+	variance /= SWEEP_STEPS;
+
+	const double dflt_us = ns_dflt * 1e-3;
+	const double worst_us = ns_step[worst] * 1e-3;
+	const double ramp_us = ns_ramp * 1e-3 / (2*SWEEP_STEPS);
+	const double stddev_us = sqrt(variance) * 1e-3;
+	const double ns_spike = fmax(ns_step[worst], ns_ramp / (2.0*SWEEP_STEPS));
+	const double spike = (ns_dflt > 0)
+		? ns_spike / ns_dflt
+		: 1.0;
+
+	const double period_ns = run->block_length * 1e9 / app->sample_rate;
+
+	// ratios of costs next to nothing are dominated by timer resolution
+	const lint_t lnt = (ns_spike > SWEEP_FLOOR * period_ns)
+		? lv2lint_limit(app, LIMIT_SWEEP_SPIKE, spike)
+		: LINT_NOTE;
+
+	if(asprintf(app->urn, "worst %.1f us at %g, ramp %.1f us, default %.1f us, "
+		"stddev %.1f us", worst_us, _sweep_value(app, port, worst, SWEEP_STEPS),
+		ramp_us, dflt_us, stddev_us) == -1)
+	{
+		*app->urn = NULL;
+	}
+
+	ret = lv2lint_grade(app, lnt, ret_sweep);
+
+	return ret;
+}
+
 static const test_t tests [] = {
 	{"Class",          _test_class},
 	{"PortProperties", _test_properties},
@@ -550,6 +743,7 @@ static const test_t tests [] = {
 	{"Comment",        _test_comment},
 	{"Group",          _test_group},
 	{"Units",          _test_unit},
+	{"Sweep",          _test_sweep},
 };
 
 static const unsigned tests_n = sizeof(tests) / sizeof(test_t);
@@ -569,9 +763,15 @@ test_port(app_t *app)
 		res_t *res = &rets[i];
 
 		res->urn = NULL;
+		res->lnt = 0;
 		app->urn = &res->urn;
+		app->lnt = &res->lnt;
 		res->ret = test->cb(app);
-		if(res->ret && (res->ret->lnt & app->show) )
+		if(!res->ret)
+			res->lnt = 0;
+		else if(!res->lnt) // not graded by the test
+			res->lnt = res->ret->lnt;
+		if(res->lnt & app->show)
 			msg = true;
 	}
 
@@ -0,0 +1,344 @@
+/*
+ * Copyright (c) 2016-2019 Hanspeter Portner (dev@open-music-kontrollers.ch)
+ *
+ * This is free software: you can redistribute it and/or modify
+ * it under the terms of the Artistic License 2.0 as published by
+ * The Perl Foundation.
+ *
+ * This source is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * Artistic License 2.0 for more details.
+ *
+ * You should have received a copy of the Artistic License 2.0
+ * along the source as a COPYING file. If not, obtain it from
+ * http://www.perlfoundation.org/artistic_license_2_0.
+ */
+
+#include <stdio.h>
+#include <errno.h>
+#include <signal.h>
+#include <dlfcn.h>
+#include <stdatomic.h>
+#include <sys/time.h>
+
+#include <lv2lint.h>
+
+#if defined(__GLIBC__)
+#	include <execinfo.h>
+
+#define PROFILE_SAMPLES  8192
+#define PROFILE_DEPTH    64
+#define PROFILE_SKIP     2 // signal handler and trampoline
+#define PROFILE_INTERVAL 1000 // us of CPU time
+
+typedef struct _sample_t sample_t;
+
+struct _sample_t {
+	int depth;
+	void *frames [PROFILE_DEPTH];
+};
+
+static sample_t *samples = NULL;
+static atomic_uint n_samples = 0;
+static struct sigaction oldact;
+
+static void
+_sigprof(int sig __unused)
+{
+	const unsigned i = atomic_fetch_add_explicit(&n_samples, 1,
+		memory_order_relaxed);
+
+	if(i < PROFILE_SAMPLES)
+	{
+		const int errno_saved = errno;
+
+		samples[i].depth = backtrace(samples[i].frames, PROFILE_DEPTH);
+
+		errno = errno_saved;
+	}
+}
+
+bool
+lv2lint_profile_start(void)
+{
+	samples = calloc(PROFILE_SAMPLES, sizeof(sample_t));
+	if(!samples)
+	{
+		return false;
+	}
+
+	// backtrace loads libgcc lazily, which must not happen in the handler
+	void *frames [1];
+	backtrace(frames, 1);
+
+	atomic_store(&n_samples, 0);
+
+	struct sigaction act;
+	memset(&act, 0x0, sizeof(act));
+	act.sa_handler = _sigprof;
+	act.sa_flags = SA_RESTART;
+	sigemptyset(&act.sa_mask);
+
+	if(sigaction(SIGPROF, &act, &oldact) == -1)
+	{
+		free(samples);
+		samples = NULL;
+		return false;
+	}
+
+	const struct itimerval timer = {
+		.it_interval = { .tv_sec = 0, .tv_usec = PROFILE_INTERVAL },
+		.it_value = { .tv_sec = 0, .tv_usec = PROFILE_INTERVAL }
+	};
+
+	if(setitimer(ITIMER_PROF, &timer, NULL) == -1)
+	{
+		sigaction(SIGPROF, &oldact, NULL);
+		free(samples);
+		samples = NULL;
+		return false;
+	}
+
+	return true;
+}
+
+void
+lv2lint_profile_stop(void)
+{
+	struct itimerval timer;
+	memset(&timer, 0x0, sizeof(timer));
+
+	setitimer(ITIMER_PROF, &timer, NULL);
+	sigaction(SIGPROF, &oldact, NULL);
+}
+
+static char *
+_symbolize(void *addr, bool leaf, const void *base, const void *symtab)
+{
+	Dl_info info;
+	char *name = NULL;
+
+	// return addresses point behind the call
+	const uintptr_t pc = (uintptr_t)addr - (leaf ? 0 : 1);
+
+	if(!dladdr((void *)pc, &info) || !info.dli_fname)
+	{
+		if(asprintf(&name, "[unknown]") == -1)
+		{
+			name = NULL;
+		}
+
+		return name;
+	}
+
+	const char *module = strrchr(info.dli_fname, '/');
+	module = module ? module + 1 : info.dli_fname;
+
+	const char *sym = info.dli_sname;
+#	ifdef ENABLE_ELF_TESTS
+	// local functions of the plugin binary are only in its .symtab
+	if(symtab && (info.dli_fbase == base))
+	{
+		const char *local = lookup_symtab(symtab, pc - (uintptr_t)info.dli_fbase);
+
+		if(local)
+		{
+			sym = local;
+		}
+	}
+#	else
+	(void)base;
+	(void)symtab;
+#	endif
+
+	if(sym)
+	{
+		if(asprintf(&name, "%s`%s", module, sym) == -1)
+		{
+			name = NULL;
+		}
+	}
+	else if(asprintf(&name, "%s`[unknown]", module) == -1)
+	{
+		name = NULL;
+	}
+
+	return name;
+}
+
+static int
+_strcmp(const void *a, const void *b)
+{
+	const char *sa = *(char *const *)a;
+	const char *sb = *(char *const *)b;
+
+	if(!sa || !sb)
+	{
+		return !sa - !sb;
+	}
+
+	return strcmp(sa, sb);
+}
+
+unsigned
+lv2lint_profile_write(FILE *f, const void *base, const void *symtab,
+	char **hottest, unsigned *n_hottest)
+{
+	unsigned n = atomic_load(&n_samples);
+	if(n > PROFILE_SAMPLES)
+	{
+		n = PROFILE_SAMPLES;
+	}
+
+	Dl_info self;
+	memset(&self, 0x0, sizeof(self));
+	dladdr((void *)&n_samples, &self); // any object of lv2lint itself
+
+	char **stacks = calloc(n, sizeof(char *));
+	char **leaves = calloc(n, sizeof(char *));
+	unsigned n_stacks = 0;
+
+	for(unsigned i = 0; stacks && leaves && (i < n); i++)
+	{
+		const sample_t *sample = &samples[i];
+		int outer = sample->depth;
+		bool in_plugin = false;
+
+		// cut the stack at the first frame of lv2lint calling into the plugin
+		for(int d = PROFILE_SKIP; d < sample->depth; d++)
+		{
+			Dl_info info;
+			if(!dladdr(sample->frames[d], &info))
+			{
+				continue;
+			}
+
+			if(info.dli_fbase == base)
+			{
+				in_plugin = true;
+			}
+			else if(in_plugin && (info.dli_fbase == self.dli_fbase))
+			{
+				outer = d;
+				break;
+			}
+		}
+
+		if(!in_plugin)
+		{
+			continue; // sample taken in lv2lint or a library called by it
+		}
+
+		// folded stacks list the root frame first
+		char *stack = NULL;
+		for(int d = outer - 1; d >= PROFILE_SKIP; d--)
+		{
+			char *name = _symbolize(sample->frames[d], d == PROFILE_SKIP, base,
+				symtab);
+			char *tmp = NULL;
+
+			if(asprintf(&tmp, "%s%s%s", stack ? stack : "", stack ? ";" : "",
+				name ? name : "[unknown]") == -1)
+			{
+				tmp = NULL;
+			}
+
+			if(d == PROFILE_SKIP)
+			{
+				leaves[n_stacks] = name;
+			}
+			else
+			{
+				free(name);
+			}
+
+			free(stack);
+			stack = tmp;
+		}
+
+		if(stack)
+		{
+			stacks[n_stacks++] = stack;
+		}
+		else
+		{
+			free(leaves[n_stacks]);
+			leaves[n_stacks] = NULL;
+		}
+	}
+
+	// count identical stacks
+	qsort(stacks, n_stacks, sizeof(char *), _strcmp);
+	for(unsigned i = 0; i < n_stacks; )
+	{
+		unsigned j = i + 1;
+
+		while( (j < n_stacks) && !strcmp(stacks[i], stacks[j]) )
+		{
+			j++;
+		}
+
+		fprintf(f, "%s %u\n", stacks[i], j - i);
+		i = j;
+	}
+
+	// find the hottest leaf function
+	*hottest = NULL;
+	*n_hottest = 0;
+	qsort(leaves, n_stacks, sizeof(char *), _strcmp);
+	for(unsigned i = 0; i < n_stacks; )
+	{
+		unsigned j = i + 1;
+
+		while( (j < n_stacks) && !_strcmp(&leaves[i], &leaves[j]) )
+		{
+			j++;
+		}
+
+		if( leaves[i] && (j - i > *n_hottest) )
+		{
+			free(*hottest);
+			*hottest = strdup(leaves[i]);
+			*n_hottest = j - i;
+		}
+
+		i = j;
+	}
+
+	for(unsigned i = 0; i < n_stacks; i++)
+	{
+		free(stacks[i]);
+		free(leaves[i]);
+	}
+	free(stacks);
+	free(leaves);
+
+	free(samples);
+	samples = NULL;
+
+	return n_stacks;
+}
+#else
+bool
+lv2lint_profile_start(void)
+{
+	return false; // not supported
+}
+
+void
+lv2lint_profile_stop(void)
+{
+	// not supported
+}
+
+unsigned
+lv2lint_profile_write(FILE *f __unused, const void *base __unused,
+	const void *symtab __unused, char **hottest, unsigned *n_hottest)
+{
+	*hottest = NULL;
+	*n_hottest = 0;
+
+	return 0;
+}
+#endif
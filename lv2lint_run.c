@@ -0,0 +1,1046 @@
+/*
+ * Copyright (c) 2016-2019 Hanspeter Portner (dev@open-music-kontrollers.ch)
+ *
+ * This is free software: you can redistribute it and/or modify
+ * it under the terms of the Artistic License 2.0 as published by
+ * The Perl Foundation.
+ *
+ * This source is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * Artistic License 2.0 for more details.
+ *
+ * You should have received a copy of the Artistic License 2.0
+ * along the source as a COPYING file. If not, obtain it from
+ * http://www.perlfoundation.org/artistic_license_2_0.
+ */
+
+#include <stdio.h>
+#include <math.h>
+#include <signal.h>
+#include <sys/mman.h>
+
+#include <lv2lint.h>
+
+#if defined(__linux__)
+#	include <sys/ioctl.h>
+#	include <sys/syscall.h>
+#	include <linux/perf_event.h>
+#endif
+
+#include <lv2/lv2plug.in/ns/ext/atom/util.h>
+#include <lv2/lv2plug.in/ns/ext/patch/patch.h>
+#include <lv2/lv2plug.in/ns/ext/midi/midi.h>
+#include <lv2/lv2plug.in/ns/ext/buf-size/buf-size.h>
+
+#define RUN_WORKER_SIZE 0x10000 // bytes per worker queue
+#define RUN_CANARY 0xa5
+#define RUN_ALIGN  64 // keep buffers aligned for plugins using SIMD
+
+static _Thread_local run_t *guarded = NULL; // harness in run() on this thread
+static _Thread_local phase_t phase = PHASE_OTHER; // of plugin on this thread
+static _Thread_local unsigned thread = 0; // ordinal, assigned on first callback
+static atomic_uint n_threads = 0;
+static struct sigaction segv_old;
+static bool segv_installed = false;
+
+static void
+_segv(int sig __unused, siginfo_t *info, void *ctx __unused)
+{
+	run_t *run = guarded;
+
+	if(run)
+	{
+		const uint8_t *addr = info->si_addr;
+
+		for(unsigned i = 0; i < run->n_ports; i++)
+		{
+			const run_port_t *port = &run->ports[i];
+			const uint8_t *guard = (const uint8_t *)port->buf + port->size + port->slack;
+			const uint8_t *end = (const uint8_t *)port->map + port->map_size;
+
+			if(port->map && (addr >= guard) && (addr < end) )
+			{
+				run->fault = i;
+				siglongjmp(run->jmp, 1);
+			}
+		}
+	}
+
+	// not ours, fault again with the previous disposition
+	sigaction(SIGSEGV, &segv_old, NULL);
+}
+
+static void
+_segv_install(void)
+{
+	if(segv_installed)
+	{
+		return;
+	}
+
+	struct sigaction act;
+	memset(&act, 0x0, sizeof(act));
+	act.sa_sigaction = _segv;
+	act.sa_flags = SA_SIGINFO;
+	sigemptyset(&act.sa_mask);
+
+	segv_installed = !sigaction(SIGSEGV, &act, &segv_old);
+}
+
+static bool
+_port_alloc(run_port_t *port)
+{
+	if( (port->type == RUN_PORT_AUDIO) || (port->type == RUN_PORT_CV)
+		|| (port->type == RUN_PORT_ATOM) )
+	{
+		// place buffer right before a guard page, so overruns fault at once,
+		// with room in front to move it to lesser alignments
+		const size_t page = sysconf(_SC_PAGESIZE);
+		const size_t span = (port->size + RUN_ALIGN - 1) & ~(RUN_ALIGN - 1);
+		const size_t size = ( (span + RUN_ALIGN + page - 1) & ~(page - 1) ) + page;
+
+		uint8_t *map = mmap(NULL, size, PROT_READ | PROT_WRITE,
+			MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if(map == MAP_FAILED)
+		{
+			return false;
+		}
+
+		if(mprotect(map + size - page, page, PROT_NONE))
+		{
+			munmap(map, size);
+			return false;
+		}
+
+		port->map = map;
+		port->map_size = size;
+		port->buf = map + size - page - span;
+		port->slack = span - port->size;
+	}
+	else if(!posix_memalign(&port->buf, RUN_ALIGN, port->size + RUN_CANARY_SIZE))
+	{
+		port->slack = RUN_CANARY_SIZE;
+	}
+	else
+	{
+		port->buf = NULL;
+		return false;
+	}
+
+	return true;
+}
+
+static void
+_port_free(run_port_t *port)
+{
+	if(port->map)
+	{
+		munmap(port->map, port->map_size);
+	}
+	else
+	{
+		free(port->buf);
+	}
+}
+
+static LV2_Worker_Status
+_queue_push(run_queue_t *queue, uint32_t size, const void *data)
+{
+	const uint32_t needed = sizeof(uint32_t) + size;
+
+	if(queue->size + needed > RUN_WORKER_SIZE)
+	{
+		return LV2_WORKER_ERR_NO_SPACE;
+	}
+
+	memcpy(&queue->buf[queue->size], &size, sizeof(uint32_t));
+	memcpy(&queue->buf[queue->size + sizeof(uint32_t)], data, size);
+	queue->size += needed;
+
+	return LV2_WORKER_SUCCESS;
+}
+
+static LV2_Worker_Status
+_respond(LV2_Worker_Respond_Handle instance, uint32_t size, const void *data)
+{
+	run_t *run = instance;
+
+	return _queue_push(&run->resps, size, data);
+}
+
+static LV2_Worker_Status
+_sched(LV2_Worker_Schedule_Handle instance, uint32_t size, const void *data)
+{
+	run_t *run = instance;
+
+	return _queue_push(&run->jobs, size, data);
+}
+
+phase_t
+lv2lint_phase_set(phase_t next)
+{
+	const phase_t prev = phase;
+
+	phase = next;
+
+	return prev;
+}
+
+phase_t
+lv2lint_phase_get(void)
+{
+	return phase;
+}
+
+unsigned
+lv2lint_thread(void)
+{
+	if(!thread)
+	{
+		thread = atomic_fetch_add_explicit(&n_threads, 1, memory_order_relaxed) + 1;
+	}
+
+	return thread;
+}
+
+void
+lv2lint_callback(app_t *app, callback_t callback, const char *what)
+{
+	callback_stats_t *stats = &app->callbacks[callback];
+
+	atomic_fetch_add_explicit(&stats->calls[phase], 1, memory_order_relaxed);
+
+	if( (phase == PHASE_RUN)
+		&& !atomic_flag_test_and_set_explicit(&stats->caught, memory_order_relaxed) )
+	{
+		stats->thread = lv2lint_thread();
+		snprintf(stats->what, sizeof(stats->what), "%s", what);
+	}
+}
+
+void
+lv2lint_callback_reset(app_t *app)
+{
+	for(unsigned c = 0; c < CALLBACK_MAX; c++)
+	{
+		callback_stats_t *stats = &app->callbacks[c];
+
+		for(unsigned p = 0; p < PHASE_MAX; p++)
+		{
+			atomic_store_explicit(&stats->calls[p], 0, memory_order_relaxed);
+		}
+
+		atomic_flag_clear_explicit(&stats->caught, memory_order_relaxed);
+		stats->thread = 0;
+		stats->what[0] = '\0';
+	}
+}
+
+static void
+_work(run_t *run)
+{
+	if(!run->work_iface)
+	{
+		run->jobs.size = 0;
+		run->resps.size = 0;
+		return;
+	}
+
+	// emulate the worker thread: run jobs, then deliver responses
+	for(size_t offset = 0; offset < run->jobs.size; )
+	{
+		uint32_t size;
+		memcpy(&size, &run->jobs.buf[offset], sizeof(uint32_t));
+
+		if(run->work_iface->work)
+		{
+			lv2lint_phase_set(PHASE_WORKER);
+			run->work_iface->work(run->handle, _respond, run, size,
+				&run->jobs.buf[offset + sizeof(uint32_t)]);
+			lv2lint_phase_set(PHASE_OTHER);
+		}
+
+		offset += sizeof(uint32_t) + size;
+	}
+	run->jobs.size = 0;
+
+	for(size_t offset = 0; offset < run->resps.size; )
+	{
+		uint32_t size;
+		memcpy(&size, &run->resps.buf[offset], sizeof(uint32_t));
+
+		if(run->work_iface->work_response)
+		{
+			lv2lint_phase_set(PHASE_RUN);
+			run->work_iface->work_response(run->handle, size,
+				&run->resps.buf[offset + sizeof(uint32_t)]);
+			lv2lint_phase_set(PHASE_OTHER);
+		}
+
+		offset += sizeof(uint32_t) + size;
+	}
+	run->resps.size = 0;
+
+	if(run->work_iface->end_run)
+	{
+		lv2lint_phase_set(PHASE_RUN);
+		run->work_iface->end_run(run->handle);
+		lv2lint_phase_set(PHASE_OTHER);
+	}
+}
+
+static void
+_map_urids(run_t *run, LV2_URID_Map *map)
+{
+	run->urid.atom_Chunk = map->map(map->handle, LV2_ATOM__Chunk);
+	run->urid.atom_Sequence = map->map(map->handle, LV2_ATOM__Sequence);
+	run->urid.atom_Object = map->map(map->handle, LV2_ATOM__Object);
+	run->urid.atom_Blank = map->map(map->handle, LV2_ATOM__Blank);
+	run->urid.atom_Bool = map->map(map->handle, LV2_ATOM__Bool);
+	run->urid.atom_Int = map->map(map->handle, LV2_ATOM__Int);
+	run->urid.atom_Long = map->map(map->handle, LV2_ATOM__Long);
+	run->urid.atom_Float = map->map(map->handle, LV2_ATOM__Float);
+	run->urid.atom_Double = map->map(map->handle, LV2_ATOM__Double);
+	run->urid.atom_String = map->map(map->handle, LV2_ATOM__String);
+	run->urid.atom_Path = map->map(map->handle, LV2_ATOM__Path);
+	run->urid.atom_URI = map->map(map->handle, LV2_ATOM__URI);
+	run->urid.atom_URID = map->map(map->handle, LV2_ATOM__URID);
+
+	run->urid.patch_Get = map->map(map->handle, LV2_PATCH__Get);
+	run->urid.patch_Set = map->map(map->handle, LV2_PATCH__Set);
+	run->urid.patch_Put = map->map(map->handle, LV2_PATCH__Put);
+	run->urid.patch_body = map->map(map->handle, LV2_PATCH__body);
+	run->urid.patch_property = map->map(map->handle, LV2_PATCH__property);
+	run->urid.patch_value = map->map(map->handle, LV2_PATCH__value);
+
+	run->urid.midi_MidiEvent = map->map(map->handle, LV2_MIDI__MidiEvent);
+
+	run->urid.bufsz_minBlockLength = map->map(map->handle,
+		LV2_BUF_SIZE__minBlockLength);
+}
+
+static const LV2_Feature *
+_opts_feature(run_t *run, const LV2_Options_Option *opts)
+{
+	unsigned o = 0;
+
+	// harness instances are run with any block length up to the maximum, e.g.
+	// when splitting blocks, thus announce a minimum of a single sample
+	run->min_block_length = 1;
+
+	for( ; opts[o].key && (o < RUN_MAX_OPTIONS - 1); o++)
+	{
+		run->opts[o] = opts[o];
+
+		if(opts[o].key == run->urid.bufsz_minBlockLength)
+		{
+			run->opts[o].value = &run->min_block_length;
+		}
+	}
+	memset(&run->opts[o], 0x0, sizeof(LV2_Options_Option)); // sentinel
+
+	run->feat_opts.URI = LV2_OPTIONS__options;
+	run->feat_opts.data = run->opts;
+
+	return &run->feat_opts;
+}
+
+static void
+_arm_inputs(run_t *run)
+{
+	for(unsigned i = 0; i < run->n_ports; i++)
+	{
+		run_port_t *port = &run->ports[i];
+
+		if( (port->type == RUN_PORT_ATOM) && port->input)
+		{
+			// start a fresh sequence to be filled via the forge
+			lv2_atom_forge_set_buffer(&port->forge, port->buf, port->size);
+			lv2_atom_forge_sequence_head(&port->forge, &port->frame, 0);
+		}
+	}
+}
+
+static void
+_arm_tails(run_t *run, uint32_t nsamples)
+{
+	for(unsigned i = 0; i < run->n_ports; i++)
+	{
+		run_port_t *port = &run->ports[i];
+
+		if( ( (port->type == RUN_PORT_AUDIO) || (port->type == RUN_PORT_CV) )
+			&& !port->input && !port->alias)
+		{
+			memset((float *)port->buf + nsamples, RUN_CANARY,
+				(run->block_length - nsamples) * sizeof(float));
+		}
+	}
+}
+
+static void
+_check_tails(run_t *run, uint32_t nsamples)
+{
+	for(unsigned i = 0; (i < run->n_ports) && (run->overrun == -1); i++)
+	{
+		const run_port_t *port = &run->ports[i];
+
+		if( ( (port->type == RUN_PORT_AUDIO) || (port->type == RUN_PORT_CV) )
+			&& !port->input && !port->alias)
+		{
+			const uint8_t *tail = (const uint8_t *)((float *)port->buf + nsamples);
+			const size_t size = (run->block_length - nsamples) * sizeof(float);
+
+			for(size_t j = 0; j < size; j++)
+			{
+				if(tail[j] != RUN_CANARY)
+				{
+					run->overrun = i;
+					break;
+				}
+			}
+		}
+	}
+}
+
+static void
+_arm_outputs(run_t *run)
+{
+	for(unsigned i = 0; i < run->n_ports; i++)
+	{
+		run_port_t *port = &run->ports[i];
+
+		if( (port->type == RUN_PORT_ATOM) && !port->input)
+		{
+			// announce the capacity of the output sequence
+			LV2_Atom *atom = port->buf;
+
+			atom->size = port->size - sizeof(LV2_Atom);
+			atom->type = run->urid.atom_Chunk;
+		}
+	}
+}
+
+#if defined(__linux__)
+static const uint64_t counter_configs [RUN_COUNTER_MAX] = {
+	[RUN_COUNTER_INSTRUCTIONS]  = PERF_COUNT_HW_INSTRUCTIONS,
+	[RUN_COUNTER_CYCLES]        = PERF_COUNT_HW_CPU_CYCLES,
+	[RUN_COUNTER_CACHE_MISSES]  = PERF_COUNT_HW_CACHE_MISSES,
+	[RUN_COUNTER_BRANCH_MISSES] = PERF_COUNT_HW_BRANCH_MISSES
+};
+
+static void
+_counters_start(run_t *run)
+{
+	if(run->counting)
+	{
+		const int leader = run->counter_fds[0];
+
+		ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+		ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+	}
+}
+
+static void
+_counters_stop(run_t *run)
+{
+	if(run->counting)
+	{
+		const int leader = run->counter_fds[0];
+		uint64_t values [1 + RUN_COUNTER_MAX]; // nr, values
+
+		ioctl(leader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+		if( (read(leader, values, sizeof(values)) == sizeof(values))
+			&& (values[0] == RUN_COUNTER_MAX) )
+		{
+			memcpy(run->counters, &values[1], sizeof(run->counters));
+		}
+		else
+		{
+			memset(run->counters, 0x0, sizeof(run->counters));
+		}
+	}
+}
+
+bool
+lv2lint_run_counters(run_t *run)
+{
+	if(run->counting)
+	{
+		return true;
+	}
+
+	// counters follow the calling thread, user space only
+	for(unsigned i = 0; i < RUN_COUNTER_MAX; i++)
+	{
+		struct perf_event_attr attr;
+
+		memset(&attr, 0x0, sizeof(attr));
+		attr.size = sizeof(attr);
+		attr.type = PERF_TYPE_HARDWARE;
+		attr.config = counter_configs[i];
+		attr.disabled = (i == 0);
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+		attr.read_format = PERF_FORMAT_GROUP;
+
+		run->counter_fds[i] = syscall(SYS_perf_event_open, &attr, 0, -1,
+			(i == 0) ? -1 : run->counter_fds[0], 0);
+
+		if(run->counter_fds[i] == -1)
+		{
+			// not supported by hardware, virtualized or not permitted
+			for(unsigned j = 0; j < i; j++)
+			{
+				close(run->counter_fds[j]);
+				run->counter_fds[j] = -1;
+			}
+
+			return false;
+		}
+	}
+
+	run->counting = true;
+
+	return true;
+}
+#else
+static void
+_counters_start(run_t *run __unused)
+{
+	// not supported
+}
+
+static void
+_counters_stop(run_t *run __unused)
+{
+	// not supported
+}
+
+bool
+lv2lint_run_counters(run_t *run __unused)
+{
+	return false;
+}
+#endif
+
+static bool
+_run_guarded(run_t *run, uint32_t nsamples)
+{
+	guarded = run;
+	lv2lint_phase_set(PHASE_RUN);
+
+	if(sigsetjmp(run->jmp, 1))
+	{
+		run->ns = lv2lint_now() - run->t0;
+		_counters_stop(run);
+		lv2lint_phase_set(PHASE_OTHER);
+		guarded = NULL;
+		return false; // hit a guard page
+	}
+
+	// timed only from here, saving the signal mask above is a system call
+	_counters_start(run);
+	run->t0 = lv2lint_now();
+	lilv_instance_run(run->instance, nsamples);
+	run->ns = lv2lint_now() - run->t0;
+	_counters_stop(run);
+	lv2lint_phase_set(PHASE_OTHER);
+	guarded = NULL;
+
+	return true;
+}
+
+run_t *
+lv2lint_run_new(app_t *app)
+{
+	if(!app->plugin || !app->features || !app->map)
+	{
+		return NULL;
+	}
+
+	run_t *run = calloc(1, sizeof(run_t));
+	if(!run)
+	{
+		return NULL;
+	}
+
+	run->app = app;
+	run->block_length = app->block_length;
+	run->fault = -1;
+	run->overrun = -1;
+	for(unsigned i = 0; i < RUN_COUNTER_MAX; i++)
+	{
+		run->counter_fds[i] = -1;
+	}
+	run->jobs.buf = malloc(RUN_WORKER_SIZE);
+	run->resps.buf = malloc(RUN_WORKER_SIZE);
+	if(!run->jobs.buf || !run->resps.buf)
+	{
+		lv2lint_run_free(run);
+		return NULL;
+	}
+
+	_map_urids(run, app->map);
+	_segv_install();
+
+	// route worker requests of this very instance to our own queue
+	run->sched.handle = run;
+	run->sched.schedule_work = _sched;
+	run->feat_sched.URI = LV2_WORKER__schedule;
+	run->feat_sched.data = &run->sched;
+
+	unsigned f = 0;
+	for(const LV2_Feature *const *feature = app->features;
+		*feature && (f < RUN_MAX_FEATURES - 1);
+		feature++)
+	{
+		if(!strcmp((*feature)->URI, LV2_WORKER__schedule))
+		{
+			run->features[f++] = &run->feat_sched;
+		}
+		else if(!strcmp((*feature)->URI, LV2_OPTIONS__options))
+		{
+			run->features[f++] = _opts_feature(run, (*feature)->data);
+		}
+		else
+		{
+			run->features[f++] = *feature;
+		}
+	}
+	run->features[f] = NULL; // sentinel
+
+	lv2lint_phase_set(PHASE_INSTANTIATE);
+	run->instance = lilv_plugin_instantiate(app->plugin, app->sample_rate,
+		run->features);
+	lv2lint_phase_set(PHASE_OTHER);
+	if(!run->instance)
+	{
+		lv2lint_run_free(run);
+		return NULL;
+	}
+
+	run->handle = lilv_instance_get_handle(run->instance);
+	run->work_iface = lilv_instance_get_extension_data(run->instance,
+		LV2_WORKER__interface);
+
+	run->n_ports = lilv_plugin_get_num_ports(app->plugin);
+	run->ports = calloc(run->n_ports, sizeof(run_port_t));
+	if(!run->ports)
+	{
+		lv2lint_run_free(run);
+		return NULL;
+	}
+
+	float *mins = alloca(run->n_ports * sizeof(float));
+	float *maxs = alloca(run->n_ports * sizeof(float));
+	float *dflts = alloca(run->n_ports * sizeof(float));
+	lilv_plugin_get_port_ranges_float(app->plugin, mins, maxs, dflts);
+
+	for(unsigned i = 0; i < run->n_ports; i++)
+	{
+		run_port_t *port = &run->ports[i];
+
+		port->port = lilv_plugin_get_port_by_index(app->plugin, i);
+		port->input = lilv_port_is_a(app->plugin, port->port, app->uris.lv2_InputPort);
+
+		if(lilv_port_is_a(app->plugin, port->port, app->uris.lv2_ControlPort))
+		{
+			port->type = RUN_PORT_CONTROL;
+			port->size = sizeof(float);
+		}
+		else if(lilv_port_is_a(app->plugin, port->port, app->uris.lv2_AudioPort))
+		{
+			port->type = RUN_PORT_AUDIO;
+			port->size = run->block_length * sizeof(float);
+		}
+		else if(lilv_port_is_a(app->plugin, port->port, app->uris.lv2_CVPort))
+		{
+			port->type = RUN_PORT_CV;
+			port->size = run->block_length * sizeof(float);
+		}
+		else if(lilv_port_is_a(app->plugin, port->port, app->uris.atom_AtomPort))
+		{
+			port->type = RUN_PORT_ATOM;
+			port->size = app->sequence_size;
+
+			LilvNode *minimum_size = lilv_port_get(app->plugin, port->port,
+				app->uris.rsz_minimumSize);
+			if(minimum_size)
+			{
+				if(lilv_node_is_int(minimum_size)
+					&& (lilv_node_as_int(minimum_size) > (int)port->size) )
+				{
+					port->size = lilv_node_as_int(minimum_size);
+				}
+
+				lilv_node_free(minimum_size);
+			}
+
+			lv2_atom_forge_init(&port->forge, app->map);
+		}
+		else
+		{
+			port->type = RUN_PORT_OTHER;
+			port->size = app->sequence_size;
+		}
+
+		port->min = isnan(mins[i]) ? 0.f : mins[i];
+		port->max = isnan(maxs[i]) ? 1.f : maxs[i];
+		port->dflt = isnan(dflts[i]) ? port->min : dflts[i];
+
+		if(!_port_alloc(port))
+		{
+			lv2lint_run_free(run);
+			return NULL;
+		}
+
+		memset(port->buf, 0x0, port->size);
+		memset((uint8_t *)port->buf + port->size, RUN_CANARY, port->slack);
+
+		if(port->type == RUN_PORT_CONTROL)
+		{
+			*(float *)port->buf = port->dflt;
+		}
+
+		lilv_instance_connect_port(run->instance, i, port->buf);
+	}
+
+	_arm_inputs(run);
+	lv2lint_phase_set(PHASE_ACTIVATE);
+	lilv_instance_activate(run->instance);
+	lv2lint_phase_set(PHASE_OTHER);
+	run->activated = true;
+
+	return run;
+}
+
+void
+lv2lint_run_free(run_t *run)
+{
+	if(!run)
+	{
+		return;
+	}
+
+	for(unsigned i = 0; i < RUN_COUNTER_MAX; i++)
+	{
+		if(run->counter_fds[i] != -1)
+		{
+			close(run->counter_fds[i]);
+		}
+	}
+
+	// interrupted run() may hold locks or half-updated state, leak the
+	// instance together with everything it may still reference
+	if(run->fault != -1)
+	{
+		return;
+	}
+
+	if(run->instance)
+	{
+		if(run->activated)
+		{
+			lilv_instance_deactivate(run->instance);
+		}
+
+		lilv_instance_free(run->instance);
+	}
+
+	if(run->ports)
+	{
+		for(unsigned i = 0; i < run->n_ports; i++)
+		{
+			_port_free(&run->ports[i]);
+		}
+
+		free(run->ports);
+	}
+
+	free(run->jobs.buf);
+	free(run->resps.buf);
+	free(run);
+}
+
+uint64_t
+lv2lint_run(run_t *run, uint32_t nsamples)
+{
+	if(nsamples > run->block_length)
+	{
+		nsamples = run->block_length;
+	}
+
+	if(run->fault != -1)
+	{
+		return 0; // instance is stuck in an interrupted run() call
+	}
+
+	for(unsigned i = 0; i < run->n_ports; i++)
+	{
+		run_port_t *port = &run->ports[i];
+
+		if( (port->type == RUN_PORT_ATOM) && port->input)
+		{
+			lv2_atom_forge_pop(&port->forge, &port->frame);
+		}
+	}
+
+	_arm_outputs(run);
+
+	// catch writes past nsamples of short blocks, the guard pages the rest
+	if(nsamples < run->block_length)
+	{
+		_arm_tails(run, nsamples);
+	}
+
+	// page faults and lazy symbol binding hit the very first call only
+	const bool first = (run->n_runs++ == 0);
+#if !defined(_WIN32)
+	struct rusage ru0;
+	if(first)
+	{
+		getrusage(RUN_RUSAGE, &ru0);
+	}
+#endif
+
+	const bool completed = _run_guarded(run, nsamples);
+
+	if(first)
+	{
+		run->first.ns = run->ns;
+#if !defined(_WIN32)
+		struct rusage ru1;
+		getrusage(RUN_RUSAGE, &ru1);
+
+		run->first.minflt = ru1.ru_minflt - ru0.ru_minflt;
+		run->first.majflt = ru1.ru_majflt - ru0.ru_majflt;
+#endif
+	}
+
+	if(!completed)
+	{
+		return 0;
+	}
+
+	if(nsamples < run->block_length)
+	{
+		_check_tails(run, nsamples);
+	}
+
+	_work(run);
+
+	// outputs stay readable until the next cycle
+	_arm_inputs(run);
+
+	return run->ns;
+}
+
+run_port_t *
+lv2lint_run_port(run_t *run, run_port_type_t type, bool input,
+	const LilvNode *supports)
+{
+	for(unsigned i = 0; i < run->n_ports; i++)
+	{
+		run_port_t *port = &run->ports[i];
+
+		if( (port->type != type) || (port->input != input) )
+		{
+			continue;
+		}
+
+		if(supports && !lilv_port_supports_event(run->app->plugin, port->port, supports))
+		{
+			continue;
+		}
+
+		return port;
+	}
+
+	return NULL;
+}
+
+run_t *
+lv2lint_run_get(app_t *app)
+{
+	// instantiate lazily, only once per plugin
+	if(!app->run && app->instance)
+	{
+		app->run = lv2lint_run_new(app);
+	}
+
+	// an interrupted instance cannot be run any more
+	if(app->run && (app->run->fault != -1) )
+	{
+		return NULL;
+	}
+
+	return app->run;
+}
+
+const ret_t *
+lv2lint_run_skipped(app_t *app)
+{
+	static const ret_t ret_skipped = {
+		.lnt = LINT_NOTE,
+		.msg = "not tested, shared instance faulted before: %s",
+		.uri = LV2_CORE__Port,
+		.dsc = "An earlier test caught run() accessing past the end of a port "
+			"buffer. The interrupted instance is left alone, tests depending on "
+			"it are skipped."
+	};
+
+	if(!app->run || (app->run->fault == -1) )
+	{
+		return NULL;
+	}
+
+	const int index = app->run->fault;
+	const LilvNode *symbol = lilv_port_get_symbol(app->plugin,
+		app->run->ports[index].port);
+
+	if(asprintf(app->urn, "port %d (%s)", index, lilv_node_as_string(symbol)) == -1)
+	{
+		*app->urn = NULL;
+	}
+
+	return &ret_skipped;
+}
+
+bool
+lv2lint_run_overflow(const run_port_t *port)
+{
+	const uint8_t *canary = (const uint8_t *)port->buf + port->size;
+
+	for(unsigned i = 0; i < port->slack; i++)
+	{
+		if(canary[i] != RUN_CANARY)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void
+lv2lint_run_alias(run_t *run, run_port_t *input, run_port_t *output)
+{
+	const uint32_t index = output - run->ports;
+
+	// process in-place, the output keeps its own buffer for later reconnection
+	output->alias = input;
+	lilv_instance_connect_port(run->instance, index, input->buf);
+}
+
+static volatile uint8_t touch_sink; // keeps touching from being optimized out
+
+void
+lv2lint_run_touch(run_t *run)
+{
+	uint8_t acc = 0;
+
+	// what lv2lint_run touches around run(), without calling the plugin
+	_arm_outputs(run);
+
+	for(unsigned i = 0; i < run->n_ports; i++)
+	{
+		const run_port_t *port = &run->ports[i];
+		const uint8_t *buf = port->buf;
+
+		for(size_t j = 0; j < port->size + port->slack; j += 64)
+		{
+			acc += buf[j];
+		}
+	}
+
+	touch_sink = acc;
+}
+
+uint32_t
+lv2lint_run_rand(uint32_t *state)
+{
+	// xorshift32
+	uint32_t x = *state;
+
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+
+	return *state = x;
+}
+
+float
+lv2lint_run_uniform(uint32_t *state)
+{
+	return (float)lv2lint_run_rand(state) / UINT32_MAX;
+}
+
+void
+lv2lint_run_signal(run_port_t *port, run_signal_t signal, uint32_t nsamples,
+	uint32_t *state)
+{
+	float *buf = port->buf;
+
+	for(uint32_t i = 0; i < nsamples; i++)
+	{
+		switch(signal)
+		{
+			case RUN_SIGNAL_SILENCE:
+				buf[i] = 0.f;
+				break;
+			case RUN_SIGNAL_NOISE:
+				buf[i] = 2.f*lv2lint_run_uniform(state) - 1.f;
+				break;
+			case RUN_SIGNAL_FULL_SCALE:
+				buf[i] = (i & 0x20) ? -1.f : 1.f;
+				break;
+			case RUN_SIGNAL_DENORMAL:
+				// decaying tail reaching into the subnormal range
+				buf[i] = ( (i & 1) ? -1e-37f : 1e-37f ) * powf(0.9f, i);
+				break;
+			case RUN_SIGNAL_MAX:
+				break;
+		}
+	}
+}
+
+void
+lv2lint_run_align(run_t *run, size_t alignment)
+{
+	for(unsigned i = 0; i < run->n_ports; i++)
+	{
+		run_port_t *port = &run->ports[i];
+
+		if( ( (port->type != RUN_PORT_AUDIO) && (port->type != RUN_PORT_CV) )
+			|| !port->map)
+		{
+			continue;
+		}
+
+		// move buffer down, aligned to exactly the given number of bytes
+		uint8_t *guard = (uint8_t *)port->buf + port->size + port->slack;
+		const size_t span = (port->size + RUN_ALIGN - 1) & ~(RUN_ALIGN - 1);
+		const size_t shift = (alignment < RUN_ALIGN)
+			? RUN_ALIGN - alignment
+			: 0;
+
+		port->buf = guard - span - shift;
+		port->slack = span + shift - port->size;
+
+		memset(port->buf, 0x0, port->size);
+		memset((uint8_t *)port->buf + port->size, RUN_CANARY, port->slack);
+
+		lilv_instance_connect_port(run->instance, i,
+			port->alias ? port->alias->buf : port->buf);
+	}
+}
+
+const void *
+lv2lint_run_buffer(run_t *run, uint32_t index)
+{
+	const run_port_t *port = &run->ports[index];
+
+	return port->alias ? port->alias->buf : port->buf;
+}
@@ -59,7 +59,7 @@ _test_symbols(app_t *app)
 			if(path)
 			{
 				char *symbols = NULL;
-				if(!test_visibility(path, "lv2ui_descriptor", &symbols))
+				if(!test_visibility(path, "lv2ui_descriptor", &symbols, NULL))
 				{
 					*app->urn = symbols;
 					ret = &ret_symbols;
@@ -581,9 +581,15 @@ test_ui(app_t *app)
 		res_t *res = &rets[i];
 
 		res->urn = NULL;
+		res->lnt = 0;
 		app->urn = &res->urn;
+		app->lnt = &res->lnt;
 		res->ret = test->cb(app);
-		if(res->ret && (res->ret->lnt & app->show) )
+		if(!res->ret)
+			res->lnt = 0;
+		else if(!res->lnt) // not graded by the test
+			res->lnt = res->ret->lnt;
+		if(res->lnt & app->show)
 			msg = true;
 	}
 